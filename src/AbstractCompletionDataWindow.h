@@ -1,14 +1,10 @@
 #pragma once
 
 #include "AbstractWindow.h"
-
-#include <stack>
-
-#include "word_stack_element.h"
+#include "WordStack.h"
 
 
 class CompletionStack;
-using WordStack = std::stack<word_stack_element>;
 
 class AbstractCompletionDataWindow : public AbstractWindow
 {
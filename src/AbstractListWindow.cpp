@@ -1,6 +1,7 @@
 #include "AbstractListWindow.h"
 
-#include <ncurses.h>
+#include <algorithm>
+#include <cstdlib>
 
 #include "AbstractTab.h"
 #include "CompletionStack.h"
@@ -11,6 +12,11 @@
 
 
 
+// see AbstractListWindow::collect_cache_stats()
+static uint64_t cache_hits{0};
+static uint64_t cache_misses{0};
+
+
 AbstractListWindow::AbstractListWindow(
     CompletionStack & cs,
     WordStack & ws,
@@ -27,7 +33,7 @@ AbstractListWindow::AbstractListWindow(
 
 void AbstractListWindow::draw_hook()
 {
-    auto words = get_words();
+    auto const & words = get_words();
 
     // new filter could result in display_start out of bounds so clamp
     if (display_start() >= (int) words.size())
@@ -35,34 +41,104 @@ void AbstractListWindow::draw_hook()
     if (display_start() < 0)
         display_start() = 0;
 
-    int display_count = (int) words.size() - display_start();
+    int const row_count = height - 2; // 2 for borders (top, bottom)
+    if ((int) drawn_rows.size() != row_count)
+    {
+        drawn_rows.assign(row_count < 0 ? 0 : row_count, drawn_row{});
+        drawn_start = -1;
+    }
+
+    // shift what is already drawn instead of redrawing every row
+    if (drawn_start != -1)
+        scroll_rows(words, display_start() - drawn_start);
+    drawn_start = display_start();
 
-    int i = 0;
-    for (; i < display_count && i < height - 2; ++i) // 2 for borders (top, bottom)
+    bool const active = is_active();
+    for (int i = 0; i < row_count; ++i)
     {
-        int word_len{0};
-        char const * word = string_from_index(words[display_start() + i], &word_len);
+        int const word = display_start() + i < (int) words.size() ? words[display_start() + i] : -1;
 
         // highlight first word
-        if (is_active() && i == 0)
-            wattron(w, A_REVERSE);
+        bool const highlighted = active && i == 0 && word != -1;
+
+        if (drawn_rows[i].word == word && drawn_rows[i].highlighted == highlighted)
+            continue;
 
-        int j = 0;
-        for (; j < word_len && j < width - 2; ++j) // 2 for borders (left, right)
-            mvwaddch(w, i + 1, j + 1, word[j]);
+        draw_row(i, word, highlighted);
+        drawn_rows[i].word = word;
+        drawn_rows[i].highlighted = highlighted;
+    }
+}
 
-        if (is_active() && i == 0)
-            wattroff(w, A_REVERSE);
 
-        // blank out rest of line
-        for (; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+void AbstractListWindow::scroll_rows(std::vector<int> const & words, int shift)
+{
+    int const row_count = (int) drawn_rows.size();
+    if (shift == 0 || std::abs(shift) > row_count / 2)
+        return;
+
+    // only scroll when the rows that stay on screen actually show the same words shifted
+    for (int i = 0; i < row_count; ++i)
+    {
+        int const from = i + shift;
+        if (from < 0 || from >= row_count)
+            continue;
+
+        int const word = drawn_start + shift + i < (int) words.size() ? words[drawn_start + shift + i] : -1;
+        if (drawn_rows[from].word != word)
+            return;
     }
 
-    // blank out remaining lines
-    for (; i < height - 2; ++i)
-        for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+    // borders of the rows scrolled into view are blanked by scrolling
+    int const left = w->char_at(1, 0);
+    int const right = w->char_at(1, width - 1);
+
+    w->scroll_region(1, row_count, shift);
+
+    if (shift > 0)
+    {
+        drawn_rows.erase(drawn_rows.begin(), drawn_rows.begin() + shift);
+        drawn_rows.insert(drawn_rows.end(), shift, drawn_row{});
+    }
+    else
+    {
+        drawn_rows.erase(drawn_rows.end() + shift, drawn_rows.end());
+        drawn_rows.insert(drawn_rows.begin(), -shift, drawn_row{});
+    }
+
+    for (int i = 0; i < row_count; ++i)
+    {
+        if (drawn_rows[i].word != -2)
+            continue;
+
+        w->put(i + 1, 0, left);
+        w->put(i + 1, width - 1, right);
+    }
+}
+
+
+void AbstractListWindow::draw_row(int row, int word, bool highlighted)
+{
+    int const row_width = width - 2; // 2 for borders (left, right)
+
+    int word_len{0};
+    char const * str{""};
+    if (word != -1)
+        str = string_from_index(word, &word_len);
+    if (word_len > row_width)
+        word_len = row_width;
+
+    if (highlighted)
+        w->attribute_on(Surface::REVERSE);
+
+    w->put_string(row + 1, 1, std::string_view{str, (size_t) word_len});
+
+    if (highlighted)
+        w->attribute_off(Surface::REVERSE);
+
+    // blank out rest of line (whline instead of wclrtoeol to keep the right border)
+    if (word_len < row_width)
+        w->fill(row + 1, word_len + 1, ' ', row_width - word_len);
 }
 
 
@@ -72,6 +148,19 @@ Layer::Type AbstractListWindow::layer() const
 }
 
 
+void AbstractListWindow::post_resize_hook()
+{
+    // new Surface, nothing drawn yet
+    drawn_rows.clear();
+}
+
+
+void AbstractListWindow::post_clear_hook()
+{
+    drawn_rows.clear();
+}
+
+
 void AbstractListWindow::on_KEY_UP()
 {
     int & ds = display_start();
@@ -79,7 +168,6 @@ void AbstractListWindow::on_KEY_UP()
     {
         --ds;
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -88,8 +176,7 @@ void AbstractListWindow::on_KEY_DOWN()
 {
     int & ds = display_start();
 
-    cache_dirty.set_false();
-    auto words = get_words();
+    auto const & words = get_words();
     if (words.size() == 0)
         return;
 
@@ -102,7 +189,6 @@ void AbstractListWindow::on_KEY_DOWN()
             ds = end;
 
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -118,7 +204,6 @@ void AbstractListWindow::on_PAGE_UP()
             ds = 0;
 
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -127,8 +212,7 @@ void AbstractListWindow::on_PAGE_DOWN()
 {
     int & ds = display_start();
 
-    cache_dirty.set_false();
-    auto words = get_words();
+    auto const & words = get_words();
 
     if (words.size() == 0)
         return;
@@ -141,10 +225,7 @@ void AbstractListWindow::on_PAGE_DOWN()
         if (ds > end)
             ds = end;
 
-        // redraw but keep data
-        // note that the get_words() call before will make the cache dirty again
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -156,7 +237,6 @@ void AbstractListWindow::on_HOME()
     {
         ds = 0;
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -165,8 +245,7 @@ void AbstractListWindow::on_END()
 {
     int & ds = display_start();
 
-    cache_dirty.set_false();
-    auto words = get_words();
+    auto const & words = get_words();
     if (words.size() == 0)
         return;
 
@@ -175,7 +254,6 @@ void AbstractListWindow::on_END()
     {
         ds = end;
         mark_dirty();
-        cache_dirty.set_false();
     }
 }
 
@@ -184,7 +262,7 @@ void AbstractListWindow::on_RETURN()
 {
     int & ds = display_start();
 
-    auto words = get_words();
+    auto const & words = get_words();
 
     if (words.size() == 0)
         return;
@@ -201,8 +279,7 @@ void AbstractListWindow::on_RETURN()
     // update completion stack
     while (cs.count() > 1)
         cs.pop();
-    for (int i = 0; i < selected_len; ++i)
-        cs.push(selected[i]);
+    cs.push(selected, selected_len);
 
     input_win.mark_dirty();
 
@@ -223,8 +300,7 @@ void AbstractListWindow::on_DELETE()
     while (cs.count() > 1)
         cs.pop();
 
-    for (auto ch : s)
-        cs.push(ch);
+    cs.push(s.c_str(), (int) s.length());
 
     ws.pop();
 
@@ -238,104 +314,102 @@ void AbstractListWindow::on_DELETE()
 void AbstractListWindow::on_TAB()
 {
     auto const & c = cs.top();
-    int prefix_len = (int) c.prefix.length();
+    int const prefix_len = (int) c.prefix.length();
+    int const end = cs.common_prefix_length();
 
-    if (c.standard_completion.size() > 0)
+    // grow up to the common prefix
+    if (end > prefix_len)
     {
-        int first_entry_len{0};
-        char const * first_entry = matchmaker::at(c.standard_completion[0], &first_entry_len);
-
-        // find out the "target_completion_count" or the completion count after skipping
-        // by common characters
-        int target_completion_count = cs.count() - 1;
-        bool ok = first_entry_len > prefix_len;
-        while (ok)
-        {
-            for (auto i : c.standard_completion)
-            {
-                int entry_len{0};
-                char const * entry = matchmaker::at(i, &entry_len);
-
-                // are entry and first_entry long enough to compare at target_completion_count?
-                if (entry_len <= target_completion_count)
-                    ok = false;
-                else if (first_entry_len <= target_completion_count)
-                    ok = false;
-
-                else if (entry[target_completion_count] != first_entry[target_completion_count])
-                    ok = false;
-            }
-
-            if (ok)
-                ++target_completion_count;
-        }
-
-        bool cs_modified{false};
-        // grow up to the target completion count
-        for (int i = prefix_len; i < target_completion_count && i < first_entry_len; ++i)
-        {
-            cs.push(first_entry[i]);
-            cs_modified = true;
-        }
-
-        if (cs_modified)
-            input_win.mark_dirty();
+        char const * first_entry = matchmaker::at(c.standard_completion[0], nullptr);
+        cs.push(first_entry + prefix_len, end - prefix_len);
+        input_win.mark_dirty();
     }
 }
 
 
 void AbstractListWindow::on_BACKSPACE()
 {
-    int old_count = cs.count();
+    int const old_count = cs.count();
+    size_t const old_queued = cs.queued_input().length();
     cs.pop();
-    int new_count = cs.count();
-    if (new_count != old_count)
+    if (cs.count() != old_count || cs.queued_input().length() != old_queued)
         input_win.mark_dirty();
 }
 
 
 void AbstractListWindow::on_printable_ascii(int key)
 {
-    bool old_count = cs.count();
-    cs.push(key);
-    if (cs.count() != old_count)
+    char const ch = (char) key;
+    on_printable_ascii_run(&ch, 1);
+}
+
+
+void AbstractListWindow::on_printable_ascii_run(char const * run, int len)
+{
+    int const old_count = cs.count();
+    size_t const old_queued = cs.queued_input().length();
+    cs.push(run, len);
+    if (cs.count() != old_count || cs.queued_input().length() != old_queued)
         input_win.mark_dirty();
 }
 
 
 std::vector<int> const & AbstractListWindow::get_words() const
 {
-    if (cache_dirty.is_dirty())
-    {
-        words_cache.clear();
+    auto & c = cs.top();
 
-        auto & c = cs.top();
+    if (c.standard_completion.size() > 0 && c.display_start >= (int) c.standard_completion.size())
+        c.display_start = (int) c.standard_completion.size() - 1;
 
-        if (c.standard_completion.size() == 0)
-            return words_cache;
+    cache_key const key{
+        cs.get_generation(),
+        uses_selection() ? c.display_start : -1,
+        wf.version,
+        matchmaker::library_generation()
+    };
 
-        if (c.display_start >= (int) c.standard_completion.size())
-            c.display_start = (int) c.standard_completion.size() - 1;
+    if (cache_valid && key == words_cache_key)
+    {
+        ++cache_hits;
+        return words_cache;
+    }
 
-        int const * unfiltered{nullptr};
-        int unfiltered_count{0};
-        unfiltered_words(c.standard_completion[c.display_start], &unfiltered, &unfiltered_count);
+    ++cache_misses;
+    cache_valid = true;
+    words_cache_key = key;
+    words_cache.clear();
 
-        words_cache.reserve(unfiltered_count);
+    if (c.standard_completion.size() == 0)
+        return words_cache;
 
-        if (!apply_filter())
-            words_cache.assign(unfiltered, unfiltered + unfiltered_count);
-        else
-            for (int i = 0; i < unfiltered_count; ++i)
-                if (wf.passes(unfiltered[i]))
-                    words_cache.push_back(unfiltered[i]);
+    int const * unfiltered{nullptr};
+    int unfiltered_count{0};
+    unfiltered_words(c.standard_completion[c.display_start], &unfiltered, &unfiltered_count);
 
-    }
+    if (!apply_filter())
+        words_cache.assign(unfiltered, unfiltered + unfiltered_count);
+    else
+        wf.apply(unfiltered, unfiltered_count, words_cache);
+    words_cache_memory.set(memory_accounting::heap_bytes(words_cache));
 
     return words_cache;
 }
 
 
+void AbstractListWindow::collect_cache_stats(cache_stats * stats)
+{
+    stats->hits = cache_hits;
+    stats->misses = cache_misses;
+}
+
+
+void AbstractListWindow::reset_cache_stats()
+{
+    cache_hits = 0;
+    cache_misses = 0;
+}
+
+
 char const * AbstractListWindow::string_from_index(int index, int * len)
 {
     return matchmaker::at(index, len);
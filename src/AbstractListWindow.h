@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "AbstractCompletionDataWindow.h"
+#include "memory_accounting.h"
 
 
 
@@ -18,6 +22,19 @@ class AbstractListWindow : public AbstractCompletionDataWindow
 public:
     AbstractListWindow(CompletionStack &, WordStack &, InputWindow &, word_filter &);
 
+    struct cache_stats
+    {
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    /**
+     * @param[out] stats get_words() calls answered from a window's cache (hits) and calls that had to rebuild
+     *     it (misses), counted over all list windows since the last reset_cache_stats()
+     */
+    static void collect_cache_stats(cache_stats * stats);
+    static void reset_cache_stats();
+
 protected:
     std::vector<int> const & get_words() const;
 
@@ -27,6 +44,8 @@ private:
     Layer::Type layer() const final;
 
     // options
+    void post_resize_hook() final;
+    void post_clear_hook() final;
     void on_KEY_UP() final;
     void on_KEY_DOWN() final;
     void on_PAGE_UP() final;
@@ -38,6 +57,7 @@ private:
     void on_TAB() final;
     void on_BACKSPACE() final;
     void on_printable_ascii(int) final;
+    void on_printable_ascii_run(char const *, int) final;
 
     // new dependencies
     virtual int & display_start() = 0;
@@ -47,20 +67,38 @@ private:
     // new options
     virtual void on_post_RETURN() {}
     virtual char const * string_from_index(int index, int * len);
+    virtual bool uses_selection() const { return true; } // false if unfiltered_words() ignores its index
+
+    // draw a single row (not counting the border) as one run of text followed by one run of blanks
+    void draw_row(int row, int word, bool highlighted);
 
-    // cache
-    std::vector<int> words;
-    class CacheDirty // because observing is disturbing (see is_dirty())
+    // scroll drawn rows by shift (positive for up) when a small change of display_start() only shifts
+    // them, leaving just the rows scrolled into view to be drawn
+    void scroll_rows(std::vector<int> const & words, int shift);
+
+    // what each row currently shows so that draw_hook() can skip rows that did not change
+    struct drawn_row
     {
-    public:
-        void set_false() { dirty = false; }
-        bool is_dirty() const { prev_dirty = dirty; dirty = true; return prev_dirty; }
-    private:
-        mutable bool dirty{true};
-        mutable bool prev_dirty{true};
+        int word{-2}; // -1 for a blank row, -2 for unknown
+        bool highlighted{false};
+    };
+    std::vector<drawn_row> drawn_rows;
+    int drawn_start{-1}; // display_start() of drawn_rows, -1 if unknown
+
+    // cache, rebuilt only when anything the words are derived from has changed
+    struct cache_key
+    {
+        uint64_t completion_generation{0};
+        int selection{-1};
+        uint64_t filter_version{0};
+        uint64_t library_generation{0};
+
+        bool operator==(cache_key const &) const = default;
     };
-    CacheDirty cache_dirty;
+    mutable bool cache_valid{false};
+    mutable cache_key words_cache_key;
     mutable std::vector<int> words_cache;
+    mutable memory_accounting::account words_cache_memory{memory_accounting::WORD_CACHES};
 
     InputWindow & input_win;
     word_filter & wf;
@@ -1,9 +1,14 @@
 #include "AbstractTab.h"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
 #include <ncurses.h>
 
 #include "AbstractWindow.h"
 #include "Settings.h"
+#include "frame.h"
 #include "Layer.h"
 #include "VisibilityAspect.h"
 #include "key_codes.h"
@@ -45,6 +50,7 @@ void AbstractTab::add_window(AbstractWindow * win)
 
     layers->mut_at(win->get_layer()).first.push_back(win);
     win->add_tab(AccessKey_AbstractWindow_add_tab(), as_handle());
+    dirty_order_stale = true;
 
     // guarantee active window by setting first window active
     if (layers->at(win->get_layer()).first.size() == 1)
@@ -65,6 +71,8 @@ void AbstractTab::draw(bool clear_first)
 {
     if (is_active())
     {
+        propagate_dirty();
+
         for (auto w : layers->mut_at(Layer::Bottom::grab()).first)
             w->draw(clear_first);
 
@@ -75,6 +83,9 @@ void AbstractTab::draw(bool clear_first)
         if (layer_Help_enabled)
             for (auto w : layers->mut_at(Layer::Help::grab()).first)
                 w->draw(clear_first);
+
+        // one terminal update per frame
+        frame::flush();
     }
 }
 
@@ -222,6 +233,50 @@ void AbstractTab::on_KEY(int key)
 }
 
 
+void AbstractTab::on_printable_run(char const * run, int len)
+{
+    if (!is_active())
+        return;
+
+    auto active_win = get_active_window();
+    if (nullptr != active_win)
+        active_win->on_printable_run(run, len);
+}
+
+
+void AbstractTab::propagate_dirty()
+{
+    if (dirty_order_stale || dirty_order_version != AbstractWindow::get_dirty_graph_version())
+    {
+        // reversed depth first post-order is a topological order
+        dirty_order.clear();
+        std::unordered_set<AbstractWindow *> visited;
+        std::function<void(AbstractWindow *)> visit =
+            [&](AbstractWindow * w)
+            {
+                if (!visited.insert(w).second)
+                    return;
+
+                for (auto dep : w->get_dirty_dependencies())
+                    visit(dep);
+
+                dirty_order.push_back(w);
+            };
+
+        for (auto l : Layer::variants())
+            for (auto w : layers->at(l).first)
+                visit(w);
+
+        std::reverse(dirty_order.begin(), dirty_order.end());
+        dirty_order_stale = false;
+        dirty_order_version = AbstractWindow::get_dirty_graph_version();
+    }
+
+    for (auto w : dirty_order)
+        w->propagate_dirty();
+}
+
+
 void AbstractTab::on_ANY_F()
 {
     if (layer_Help_enabled)
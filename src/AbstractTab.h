@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -61,7 +62,8 @@ public:
     void resize();
 
     /**
-     * redraw all windows managed by the tab
+     * redraw all windows managed by the tab, layer by layer, then send the frame to the terminal
+     * with a single frame::flush()
      * @see AbstractWindow::draw()
      */
     void draw(bool clear_first);
@@ -125,6 +127,16 @@ public:
      */
     void on_KEY(int key);
 
+    /**
+     * Event handler for a run of printable ascii keys typed ahead of a single draw.
+     * The run is forwarded as a whole to the active window of the top-most enabled layer, so it must not
+     *     contain keys caught by the tab itself (',')
+     *
+     * @param[in] run printable ascii keys to be handled
+     * @param[in] len number of keys in run
+     */
+    void on_printable_run(char const * run, int len);
+
     /**
      * Indicator positions start at 0 and go from right to left
      *
@@ -144,6 +156,9 @@ private:
     void on_SHIFT_LEFT();
     void on_SHIFT_RIGHT();
 
+    // mark dirty whatever depends on dirty windows, see AbstractWindow::propagate_dirty()
+    void propagate_dirty();
+
 
 private:
     Tab::Type left_neighbor;
@@ -159,6 +174,11 @@ private:
     bool layer_F_enabled{false};
     bool layer_Help_enabled{false};
 
+    // all windows reachable through dirty dependencies, each appearing before the windows depending on it
+    std::vector<AbstractWindow *> dirty_order;
+    bool dirty_order_stale{true};
+    uint64_t dirty_order_version{0};
+
     // static variable for the active tab (look like a function but its a variable)
     static AbstractTab * & active_tab() { static AbstractTab * tab; return tab; }
 };
@@ -8,7 +8,9 @@
 #include "CompletionStack.h"
 #include "Settings.h"
 #include "Layer.h"
+#include "Renderer.h"
 #include "VisibilityAspect.h"
+#include "frame.h"
 #include "key_codes.h"
 
 
@@ -19,6 +21,9 @@ static int const MIN_ROOT_Y{27};
 // minimum required terminal width
 static int const MIN_ROOT_X{80};
 
+// see AbstractWindow::get_dirty_graph_version()
+static uint64_t dirty_graph_version{0};
+
 
 
 AbstractWindow::AbstractWindow()
@@ -32,8 +37,6 @@ AbstractWindow::AbstractWindow()
 
 AbstractWindow::~AbstractWindow()
 {
-    delwin(w);
-    w = nullptr;
 }
 
 
@@ -41,8 +44,9 @@ void AbstractWindow::clear()
 {
     if (nullptr != w)
     {
-        wclear(w);
-        wrefresh(w);
+        w->clear();
+        post_clear_hook();
+        w->stage();
     }
 }
 
@@ -52,16 +56,29 @@ void AbstractWindow::resize()
     if (!is_enabled())
         return;
 
+    int const old_height = height;
+    int const old_width = width;
+    int const old_y = y;
+    int const old_x = x;
+
+    Renderer::get().get_size(root_y, root_x);
+    resize_hook();
+
     if (nullptr != w)
     {
+        // nothing to do if the geometry did not change
+        if (height == old_height && width == old_width && y == old_y && x == old_x)
+            return;
+
+        // blank out the old area, then reuse the Surface if it can be resized and moved in place
         clear();
-        delwin(w);
-        w = nullptr;
+        if (!w->resize(height, width) || !w->move_to(y, x))
+            w.reset();
     }
 
-    getmaxyx(stdscr, root_y, root_x);
-    resize_hook();
-    w = newwin(height, width, y, x);
+    if (nullptr == w)
+        w = Renderer::get().create_surface(height, width, y, x);
+
     post_resize_hook();
     mark_dirty();
 }
@@ -72,46 +89,95 @@ void AbstractWindow::draw(bool clear_first)
     if (!is_enabled())
         return;
 
+    // the renderer could not create a surface (see resize()), nothing to draw on
+    if (nullptr == w)
+        return;
+
     // check terminal for minimum size requirement
     if (root_y < MIN_ROOT_Y || root_x < MIN_ROOT_X)
     {
-        wclear(w);
-        wrefresh(w);
+        clear();
         return;
     }
 
+    // a clear skipped by an earlier frame is still owed
+    clear_first = clear_first || clear_pending;
+
     // always draw when clear_first regardless of dirty
     if (!dirty && !clear_first)
         return;
 
+    // at most once per frame, anything left dirty is drawn with the next frame, and so is a forced clear
+    if (drawn_frame == frame::number() + 1)
+    {
+        dirty = true;
+        clear_pending = clear_first;
+        frame::record_skipped_draw();
+        return;
+    }
+    clear_pending = false;
+
+    if (frame::stats_enabled())
+    {
+        if (clear_first)
+            frame::record_draw(get_title(), "forced");
+        else if (nullptr == dirty_source)
+            frame::record_draw(get_title(), "marked");
+        else
+            frame::record_draw(get_title(), "via " + dirty_source->get_title());
+    }
+
     if (clear_first)
-        wclear(w);
+    {
+        w->clear();
+        post_clear_hook();
+    }
+
+    // windows of other layers may have been drawn over this one, so have stage() copy every line even if
+    // draw_hook() skips some. The renderer's flush still only sends what actually differs
+    w->touch();
 
     // border
     if (EnablednessSetting::Borders::grab().as_enabledness() == Enabledness::Enabled::grab() && borders_enabled())
-        box(w, 0, 0);
+        w->draw_border();
 
     // title
     {
-        int indent = width - (int) ((width / 1.618 + title().length() / 2.0) + 0.5);
-        mvwaddch(w, 0, indent - 1, ' ');
+        std::string const & t = get_title();
+        int indent = width - (int) ((width / 1.618 + t.length() / 2.0) + 0.5);
+        w->put(0, indent - 1, ' ');
         {
             int const active_indicator_left = is_active() ? '>' : ' ';
             int const active_indicator_right = is_active() ? '<' : ' ';
-            mvwaddch(w, 0, indent - 2, active_indicator_left);
-            mvwaddch(w, 0, title().size() + indent + 1, active_indicator_right);
+            w->put(0, indent - 2, active_indicator_left);
+            w->put(0, t.size() + indent + 1, active_indicator_right);
         }
-        for (int i = 0; i < (int) title().size(); ++i)
-            mvwaddch(w, 0, i + indent, title()[i]);
-        mvwaddch(w, 0, title().size() + indent, ' ');
+        w->put_string(0, indent, t);
+        w->put(0, t.size() + indent, ' ');
     }
 
     // window specific drawing
     draw_hook();
 
     dirty = false;
+    dirty_source = nullptr;
+    drawn_frame = frame::number() + 1;
 
-    wrefresh(w);
+    // staged only, AbstractTab::draw() sends the whole frame at once
+    w->stage();
+}
+
+
+std::string const & AbstractWindow::get_title()
+{
+    // title() may query matchmaker so only call it once per dirty cycle
+    if (title_dirty)
+    {
+        title(cached_title);
+        title_dirty = false;
+    }
+
+    return cached_title;
 }
 
 
@@ -223,17 +289,64 @@ void AbstractWindow::on_KEY(int key)
 }
 
 
+void AbstractWindow::on_printable_run(char const * run, int len)
+{
+    if (!is_enabled())
+        return;
+
+    if (!is_active())
+        return;
+
+    on_printable_ascii_run(run, len);
+}
+
+
+void AbstractWindow::on_printable_ascii_run(char const * run, int len)
+{
+    for (int i = 0; i < len; ++i)
+        on_printable_ascii(run[i]);
+}
+
+
 void AbstractWindow::mark_dirty()
 {
     dirty = true;
-    for (auto dep : dirty_dependencies)
-        dep->mark_dirty();
+    title_dirty = true;
+    dirty_source = nullptr;
 }
 
 
 void AbstractWindow::add_dirty_dependency(AbstractWindow * dep)
 {
     dirty_dependencies.push_back(dep);
+    ++dirty_graph_version;
+}
+
+
+uint64_t AbstractWindow::get_dirty_graph_version()
+{
+    return dirty_graph_version;
+}
+
+
+void AbstractWindow::propagate_dirty()
+{
+    // a disabled window is not drawn and so stays dirty until enabled, which is no change of its dependents
+    if (!dirty || !is_enabled())
+        return;
+
+    for (auto dep : dirty_dependencies)
+    {
+        if (dep->dirty)
+        {
+            dep->title_dirty = true;
+        }
+        else
+        {
+            dep->mark_dirty();
+            dep->dirty_source = this;
+        }
+    }
 }
 
 
@@ -275,8 +388,7 @@ void AbstractWindow::disable(VisibilityAspect::Type aspect)
         if (nullptr != w)
         {
             clear();
-            delwin(w);
-            w = nullptr;
+            w.reset();
         }
     }
 
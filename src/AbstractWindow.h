@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <stack>
@@ -8,15 +9,14 @@
 
 #include <matchable/matchable_fwd.h>
 
+#include "Renderer.h"
 #include "word_stack_element.h"
 
 
-// ncurses window
-typedef struct _win_st WINDOW;
 
 class AbstractTab;
 class CompletionStack;
-using WordStack = std::stack<word_stack_element>;
+class WordStack;
 MATCHABLE_FWD(Layer);
 MATCHABLE_FWD(Tab);
 MATCHABLE_FWD(VisibilityAspect);
@@ -29,7 +29,7 @@ class AccessKey_AbstractWindow_add_tab { friend AbstractTab; AccessKey_AbstractW
 
 
 /**
- * AbstractWindow serves as the base for all windows, wrapping the low-level ncurses WINDOW type.
+ * AbstractWindow serves as the base for all windows, drawing on a Surface created by the current Renderer.
  */
 class AbstractWindow
 {
@@ -41,21 +41,25 @@ public:
     virtual ~AbstractWindow();
 
     /**
-     * clear and refresh the window
+     * clear the window, staging the cleared content for the next frame (see frame::flush())
+     *
+     * derivers that remember what they have drawn may implement post_clear_hook() to forget it
      */
     void clear();
 
     /**
-     * delete and recreate the underlying ncurses WINDOW using the size and location specified by
-     * the deriver's resize_hook()
+     * resize and move the underlying Surface to the size and location specified by the deriver's
+     * resize_hook(), recreating it only when the renderer cannot resize or move it in place.
+     * Nothing is done (and nothing redrawn) when the size and location did not change
      *
      * derivers may optionally implement post_resize_hook() if they need to react on resize after the
-     * new underlying WINDOW has been created.
+     * underlying Surface has been resized or created.
      */
     void resize();
 
     /**
-     * Conditionally redraws the window if it is enabled and has been marked dirty
+     * Conditionally redraws the window if it is enabled and has been marked dirty.
+     * The result is only staged with Surface::stage(), frame::flush() sends it to the terminal
      * @see is_enabled()
      * @see mark_dirty()
      *
@@ -83,26 +87,32 @@ public:
     int get_width() const { return width; }
 
     /**
-     * @returns The window's y position within the ncurses "stdscr"
+     * @returns The window's y position on the screen
      */
     int get_y() const { return y; }
 
     /**
-     * @returns The window's x position within the ncurses "stdscr"
+     * @returns The window's x position on the screen
      */
     int get_x() const { return x; }
 
     /**
-     * @returns The underlying ncurses WINDOW
+     * @returns The underlying Surface, nullptr while the window is disabled
      */
-    WINDOW * get_WINDOW() const { return w; }
+    Surface * get_surface() const { return w.get(); }
 
     /**
-     * Titles are provided by derivers by implementing title()
+     * @returns The ncurses WINDOW for keyboard input, nullptr if the renderer has none (see Surface)
+     */
+    WINDOW * get_WINDOW() const { return nullptr == w ? nullptr : w->input_window(); }
+
+    /**
+     * Titles are provided by derivers by implementing title(), which assigns the cached title in place so
+     * that its buffer is reused. The result is cached until the window is marked dirty again (see mark_dirty())
      *
      * @returns The windows title
      */
-    std::string get_title() { return title(); }
+    std::string const & get_title();
 
     /**
      * Defines window switching behavior when switching to the left.
@@ -164,10 +174,21 @@ public:
      */
     void on_KEY(int key);
 
+    /**
+     * Event handler for a run of printable ascii keys typed ahead of a single draw.
+     * Equivalent to calling on_KEY() for each key but allows windows to handle the run as a whole
+     *
+     * @param[in] run printable ascii keys to be handled
+     * @param[in] len number of keys in run
+     */
+    void on_printable_run(char const * run, int len);
+
     /**
      * Allows draw() to always be called within an event loop while maintaining efficiency.
      * Only when the window is "dirty" will draw be performed.
-     * Use mark_dirty() to signify that the window needs to be redrawn
+     * Use mark_dirty() to signify that the window needs to be redrawn.
+     * Marking dirty also invalidates the cached title (see get_title()).
+     * Dirty dependencies are only marked once the tab resolves dirtiness before drawing (see propagate_dirty())
      */
     void mark_dirty();
 
@@ -179,6 +200,23 @@ public:
      */
     void add_dirty_dependency(AbstractWindow * win);
 
+    /**
+     * @returns The windows that inherit this window's dirtiness (see add_dirty_dependency())
+     */
+    std::vector<AbstractWindow *> const & get_dirty_dependencies() const { return dirty_dependencies; }
+
+    /**
+     * @returns A number that changes whenever any window adds a dirty dependency
+     */
+    static uint64_t get_dirty_graph_version();
+
+    /**
+     * If dirty and enabled, mark the dirty dependencies dirty too.
+     * Called by AbstractTab::draw() for all windows in topological order, so that each window's dirtiness
+     * is complete before it passes it on
+     */
+    void propagate_dirty();
+
     /**
      * Set the window's enabledness for some given VisibilityAspect.
      * A window may be enabled or disabled for various reasons.
@@ -235,7 +273,7 @@ public:
 
 private:
     // dependencies
-    virtual std::string title() = 0;
+    virtual void title(std::string & t) = 0;
     virtual void resize_hook() = 0;
     virtual void draw_hook() = 0;
     virtual Layer::Type layer() const = 0;
@@ -243,6 +281,7 @@ private:
     // options
     virtual bool borders_enabled() const { return true; }
     virtual void post_resize_hook() {};
+    virtual void post_clear_hook() {}
     virtual void pre_disable_hook() {}
     virtual void on_KEY_UP() {}
     virtual void on_KEY_DOWN() {}
@@ -255,13 +294,14 @@ private:
     virtual void on_TAB() {}
     virtual void on_BACKSPACE() {}
     virtual void on_printable_ascii(int) {}
+    virtual void on_printable_ascii_run(char const * run, int len);
 
     // common implementation for activate_left() and activate_right()
     void activate_neighbor(Tab::Type, std::function<AbstractWindow * (AbstractWindow *, Tab::Type)>);
 
 
 protected:
-    WINDOW * w{nullptr};
+    std::unique_ptr<Surface> w;
     int root_y{0};
     int root_x{0};
     int height{0};
@@ -273,6 +313,11 @@ protected:
 private:
     std::shared_ptr<VisibilityAspect::Flags> disabled;
     bool dirty{false};
+    bool clear_pending{false};              // a draw(true) skipped as already drawn in the frame
+    bool title_dirty{true};
+    AbstractWindow * dirty_source{nullptr}; // window that passed on its dirtiness, nullptr if marked directly
+    uint64_t drawn_frame{0};                // frame::number() + 1 of the last draw, 0 if never drawn
+    std::string cached_title;
     std::vector<AbstractWindow *> dirty_dependencies;
     std::shared_ptr<matchable::MatchBox<Tab::Type, AbstractWindow *>> left_neighbor;
     std::shared_ptr<matchable::MatchBox<Tab::Type, AbstractWindow *>> right_neighbor;
@@ -7,10 +7,9 @@
 
 
 
-std::string AccessHelpWindow::title()
+void AccessHelpWindow::title(std::string & t)
 {
-    static std::string const t{"press ',' for help"};
-    return t;
+    t = "press ',' for help";
 }
 
 
@@ -12,7 +12,7 @@ class AccessHelpWindow : public AbstractWindow
     using AbstractWindow::AbstractWindow;
 
     // resolved dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final {}
     Layer::Type layer() const final;
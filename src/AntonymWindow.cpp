@@ -26,16 +26,11 @@ AntonymWindow::AntonymWindow(
 }
 
 
-std::string AntonymWindow::title()
+void AntonymWindow::title(std::string & t)
 {
-    std::string t{"Antonyms ("};
-
-    auto ant = get_words();
-    t += std::to_string(ant.size());
-
+    t = "Antonyms (";
+    t += std::to_string(get_words().size());
     t += ")";
-
-    return t;
 }
 
 
@@ -26,7 +26,7 @@ public:
 
 private:
     // resolved AbstractWindow dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
 
     // resolved AbstractListWindow dependencies
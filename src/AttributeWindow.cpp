@@ -2,6 +2,7 @@
 
 #include <cstring>
 #include <iostream>
+#include <string_view>
 
 #include <ncurses.h>
 
@@ -32,10 +33,9 @@ AttributeWindow::AttributeWindow(
 }
 
 
-std::string AttributeWindow::title()
+void AttributeWindow::title(std::string & t)
 {
-    static std::string const t{"Attributes"};
-    return t;
+    t = "Attributes";
 }
 
 
@@ -58,37 +58,32 @@ void AttributeWindow::draw_hook()
     int line = 1;
 
     {
-        std::string const att_label{"     Attributes:"};
-        mvwprintw(w, line, 1, "%s", att_label.c_str());
-
-        static std::string const att_name = "name";
-        static std::string const att_male_name = "male name";
-        static std::string const att_female_name = "female name";
-        static std::string const att_place = "place";
-        static std::string const att_compound = "compound";
-        static std::string const att_acronym = "acronym";
-
-        std::vector<std::string const *> attributes;
-        if (matchmaker::is_name(selection))        attributes.push_back(&att_name);
-        if (matchmaker::is_male_name(selection))   attributes.push_back(&att_male_name);
-        if (matchmaker::is_female_name(selection)) attributes.push_back(&att_female_name);
-        if (matchmaker::is_place(selection))       attributes.push_back(&att_place);
-        if (matchmaker::is_compound(selection))    attributes.push_back(&att_compound);
-        if (matchmaker::is_acronym(selection))     attributes.push_back(&att_acronym);
+        std::string_view const att_label{"     Attributes:"};
+        w->put_string(line, 1, att_label);
+
+        // drawn on every change of the selection, so nothing here allocates
+        std::string_view attributes[6];
+        int attribute_count{0};
+        if (matchmaker::is_name(selection))        attributes[attribute_count++] = "name";
+        if (matchmaker::is_male_name(selection))   attributes[attribute_count++] = "male name";
+        if (matchmaker::is_female_name(selection)) attributes[attribute_count++] = "female name";
+        if (matchmaker::is_place(selection))       attributes[attribute_count++] = "place";
+        if (matchmaker::is_compound(selection))    attributes[attribute_count++] = "compound";
+        if (matchmaker::is_acronym(selection))     attributes[attribute_count++] = "acronym";
 
         int indent = att_label.size() + 1;
-        for (auto att : attributes)
+        for (int a = 0; a < attribute_count; ++a)
         {
-            if (width - indent <= (int) att->length() + 2)
+            if (width - indent <= (int) attributes[a].length() + 2)
                 break;
 
-            mvwprintw(w, line, indent, "  ");
-            mvwprintw(w, line, indent + 2, "%s", att->c_str());
-            indent += att->length() + 2;
+            w->put_string(line, indent, "  ");
+            w->put_string(line, indent + 2, attributes[a]);
+            indent += attributes[a].length() + 2;
         }
 
         for (; indent < width - 1; ++indent)
-            mvwaddch(w, line, indent, ' ');
+            w->put(line, indent, ' ');
     }
 
     ++line;
@@ -99,8 +94,8 @@ void AttributeWindow::draw_hook()
         int pos_count{0};
         matchmaker::parts_of_speech(selection, &pos, &flagged, &pos_count);
 
-        std::string const pos_label{"Parts of Speech:"};
-        mvwprintw(w, line, 1, "%s", pos_label.c_str());
+        std::string_view const pos_label{"Parts of Speech:"};
+        w->put_string(line, 1, pos_label);
 
         int indent = pos_label.size() + 1;
         for (int pos_index = 0; pos_index < pos_count; ++pos_index)
@@ -114,7 +109,7 @@ void AttributeWindow::draw_hook()
             if (width - indent <= p_len + 2)
             {
                 for (; indent < width - 1; ++indent)
-                    mvwaddch(w, line, indent, ' ');
+                    w->put(line, indent, ' ');
 
                 ++line;
                 indent = pos_label.size() + 1;
@@ -125,15 +120,15 @@ void AttributeWindow::draw_hook()
                 break;
             }
 
-            mvwprintw(w, line, indent, "  ");
-            mvwprintw(w, line, indent + 2, "%s", p);
+            w->put_string(line, indent, "  ");
+            w->put_string(line, indent + 2, p);
             indent += p_len + 2;
         }
 
         for (; line < 4; ++line)
         {
             for (; indent < width - 1; ++indent)
-                mvwaddch(w, line, indent, ' ');
+                w->put(line, indent, ' ');
 
             indent = pos_label.size() + 1;
         }
@@ -26,7 +26,7 @@ public:
     );
 
 private:
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
@@ -36,10 +36,9 @@ static std::vector<std::string> const content =
 
 
 
-std::string CompletableHelpWindow::title()
+void CompletableHelpWindow::title(std::string & t)
 {
-    static std::string const t{"Help"};
-    return t;
+    t = "Help";
 }
 
 
@@ -73,17 +72,17 @@ void CompletableHelpWindow::draw_hook()
 
         int j = 0;
         for (; j < (int) line.size() && j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, line[j]);
+            w->put(i + 1, j + 1, line[j]);
 
         // blank out rest of line
         for (; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
     }
 
     // blank out remaining lines
     for (; i < height - 2; ++i)
         for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
 }
 
 
@@ -11,7 +11,7 @@ class CompletableHelpWindow : public AbstractWindow
 {
     using AbstractWindow::AbstractWindow;
 
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
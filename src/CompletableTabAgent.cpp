@@ -188,3 +188,16 @@ CompletableTabAgent::CompletableTabAgent(
         }
     );
 }
+
+
+void CompletableTabAgent::collect_background_work()
+{
+    // a rebuilt root changes what every window shows, which all depend on the input window
+    bool const root_pending = cs->top().standard_completion_pending;
+    if (!cs->collect())
+        return;
+
+    len_completion_win->mark_dirty();
+    if (root_pending)
+        input_win->mark_dirty();
+}
@@ -1,9 +1,9 @@
 #pragma once
 
 #include <memory>
-#include <stack>
 
 #include "CompletableTab.h"
+#include "WordStack.h"
 
 
 
@@ -21,7 +21,6 @@ class TabDescriptionWindow;
 class SynonymWindow;
 
 struct word_filter;
-struct word_stack_element;
 
 
 /**
@@ -36,13 +35,18 @@ public:
     CompletableTabAgent(std::shared_ptr<TabDescriptionWindow>, std::shared_ptr<IndicatorWindow>);
     CompletableTab * operator()() { return completable_tab.get(); }
 
+    /**
+     * Collect a length completion finished in the background, marking the windows showing it dirty
+     */
+    void collect_background_work();
+
 private:
     std::shared_ptr<TabDescriptionWindow> tab_desc_win;
     std::shared_ptr<IndicatorWindow> indicator_win;
 
     std::shared_ptr<word_filter> wf;
     std::shared_ptr<CompletionStack> cs;
-    std::stack<word_stack_element> ws;
+    WordStack ws;
     std::shared_ptr<InputWindow> input_win;
     std::shared_ptr<CompletionWindow> completion_win;
     std::shared_ptr<LengthCompletionWindow> len_completion_win;
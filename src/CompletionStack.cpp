@@ -1,111 +1,509 @@
 #include "CompletionStack.h"
 
-#include <queue>
+#include <algorithm>
+#include <future>
+#include <utility>
 
 #include "MatchmakerState.h"
+#include "TaskProgress.h"
+#include "event_loop.h"
 #include "matchmaker.h"
+#include "thread_pool.h"
 #include "word_filter.h"
 
 
 
+// length completions of at least this many words are calculated by the background worker
+static int const BACKGROUND_THRESHOLD{4096};
+
+// words handled by the background worker between checks for cancellation
+static int const CANCELLATION_INTERVAL{1024};
+
+// words filtered by a single thread_pool task, between progress reports and checks for cancellation
+static int const FILTER_CHUNK{4096};
+
+
+
 CompletionStack::CompletionStack(word_filter const & f) : wf(f)
 {
     clear_top();
 }
 
 
+CompletionStack::~CompletionStack()
+{
+    std::unique_lock<std::mutex> lock{worker_mutex};
+    stopping = true;
+    ++generation; // cancel anything in progress
+    worker_cv.wait(lock, [this]() { return !worker_scheduled; });
+}
+
+
 void CompletionStack::push(int ch)
 {
-    if (MatchmakerState::Instance::grab().as_state() == LibraryState::Unloaded::grab())
+    char const c = (char) ch;
+    push(&c, 1);
+}
+
+
+void CompletionStack::push(char const * chars, int count)
+{
+    // nothing to slice from yet, and pushing would cancel the root being built
+    if (completions[0].standard_completion_pending)
+    {
+        if (MatchmakerState::Instance::grab().as_state() != LibraryState::Unloaded::grab())
+            queued.append(chars, std::min(count, CAPACITY - 1 - (int) queued.length()));
         return;
+    }
+
+    int const old_count = completion_count;
+
+    for (int i = 0; i < count; ++i)
+        grow(chars[i]);
+
+    if (completion_count != old_count)
+    {
+        ++generation;
+        update_length_completion();
+        account_memory();
+    }
+}
+
+
+bool CompletionStack::grow(int ch)
+{
+    if (MatchmakerState::Instance::grab().as_state() == LibraryState::Unloaded::grab())
+        return false;
 
     if (completion_count >= CAPACITY)
+        return false;
+
+    std::string prefix{top().prefix};
+    prefix += (char) ch;
+
+    int start{0};
+    int length{0};
+    matchmaker::complete(prefix.c_str(), &start, &length);
+
+    // the new completion is a subrange of the previous (already filtered and sorted) completion
+    auto const prev = top().standard_completion;
+    auto first = std::lower_bound(prev.begin(), prev.end(), start);
+    auto last = std::lower_bound(first, prev.end(), start + length);
+
+    // if adding 'ch' would make an unknown word then ignore the push, leaving the generation and so
+    // whatever the worker calculates for the top untouched
+    if (first == last)
+        return false;
+
+    ++completion_count;
+    reset_top();
+    top().prefix.assign(prefix);
+    top().standard_completion = std::span<int const>{first, last};
+    top().length_completion_pending = true;
+
+    return true;
+}
+
+
+void CompletionStack::pop()
+{
+    if (!queued.empty())
+    {
+        queued.pop_back();
         return;
+    }
 
+    if (completion_count > 1)
     {
-        // keep reference to previous top for prefix initialization
-        completion const & prev_top = top();
+        --completion_count;
+        ++generation;
 
-        // grow
-        ++completion_count;
+        if (top().length_completion_pending)
+        {
+            update_length_completion();
+            account_memory();
+        }
+    }
+}
 
-        clear_top();
-        top().prefix = prev_top.prefix;
+
+void CompletionStack::update_length_completion()
+{
+    auto & c = top();
+    if ((int) c.standard_completion.size() < BACKGROUND_THRESHOLD)
+    {
+        calculate_length_completion(c);
+        return;
     }
-    top().prefix += ch;
 
-    // get new completion
+    c.length_completion.clear();
+    c.length_completion_pending = true;
+
+    job j;
+    j.generation = generation;
+    j.level = completion_count - 1;
+    j.words = root_words;
+    j.range = c.standard_completion;
+    post_job(std::move(j));
+}
+
+
+void CompletionStack::post_root_job()
+{
+    auto & c = top();
+    c.standard_completion = {};
+    c.standard_completion_pending = true;
+    c.length_completion.clear();
+    c.length_completion_pending = true;
+
+    // the filter may be edited while the worker runs
+    job j;
+    j.generation = generation;
+    j.filter = std::make_shared<word_filter const>(wf);
+    post_job(std::move(j));
+}
+
+
+void CompletionStack::post_job(job j)
+{
     {
-        int start{0};
-        int length{0};
-        matchmaker::complete(
-            top().prefix.c_str(),
-            &start,
-            &length
-        );
-        top().standard_completion.reserve(length);
-        for (int i = start; i < start + length; ++i)
-            if (wf.passes(i))
-                top().standard_completion.push_back(i);
+        std::lock_guard<std::mutex> lock{worker_mutex};
+        posted = std::move(j);
+        job_posted = true;
 
-        // if adding 'ch' would make an unknown word then ignore (undo) the push
-        if (top().standard_completion.size() == 0)
-        {
-            pop();
+        if (worker_scheduled)
             return;
+        worker_scheduled = true;
+    }
+
+    // results are shown whenever they are ready, input never waits for them
+    thread_pool::post(thread_pool::IDLE, [this]() { work(); });
+}
+
+
+bool CompletionStack::collect()
+{
+    {
+        std::lock_guard<std::mutex> lock{worker_mutex};
+        if (!job_finished)
+            return false;
+
+        job_finished = false;
+        if (finished.generation != generation || finished.level != completion_count - 1)
+            return false;
+
+        if (finished.filter)
+            set_root(std::move(finished.words));
+        finished.filter.reset();
+        finished.words.reset();
+
+        std::swap(top().length_completion, finished.length_completion);
+        top().length_completion_pending = false;
+
+        // nothing is in progress for the current generation anymore, so moving on cancels nothing
+        ++generation;
+    }
+
+    if (!push_queued_input())
+        account_memory();
+
+    return true;
+}
+
+
+void CompletionStack::work()
+{
+    job current;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock{worker_mutex};
+            if (stopping || !job_posted)
+            {
+                worker_scheduled = false;
+                worker_cv.notify_all();
+                return;
+            }
+
+            std::swap(current, posted);
+            job_posted = false;
+
+            // whatever the previous job left here is not needed anymore
+            posted.filter.reset();
+            posted.words.reset();
         }
+
+        if (!calculate(current))
+            continue;
+
+        {
+            std::lock_guard<std::mutex> lock{worker_mutex};
+            std::swap(current, finished);
+            job_finished = true;
+        }
+        event_loop::wake();
     }
+}
 
-    // calculate length completion
-    top().length_completion.reserve(top().standard_completion.size());
-    std::make_heap(top().length_completion.begin(), top().length_completion.end());
-    for (auto const & i : top().standard_completion)
+
+bool CompletionStack::calculate(job & j) const
+{
+    if (j.filter)
     {
-        top().length_completion.push_back(matchmaker::as_longest(i));
-        std::push_heap(top().length_completion.begin(), top().length_completion.end());
+        int count{0};
+        {
+            auto library_lock = matchmaker::lock_library();
+            if (!library_lock.owns_lock())
+                return false;
+            count = matchmaker::count();
+        }
+
+        // the filter tasks lock the library themselves
+        auto words = std::make_shared<std::vector<int>>();
+        filter_dictionary(*j.filter, count, *words, nullptr);
+        if (j.generation != generation)
+            return false;
+
+        j.range = *words;
+        j.words = std::move(words);
     }
-    std::sort_heap(top().length_completion.begin(), top().length_completion.end());
-    top().display_start = 0;
-    top().len_display_start = 0;
+
+    j.length_completion.clear();
+    j.length_completion.reserve(j.range.size());
+
+    {
+        auto library_lock = matchmaker::lock_library();
+        if (!library_lock.owns_lock())
+            return false;
+
+        for (int i = 0; i < (int) j.range.size(); ++i)
+        {
+            if (i % CANCELLATION_INTERVAL == 0 && j.generation != generation.load(std::memory_order_relaxed))
+                return false;
+
+            j.length_completion.push_back(matchmaker::as_longest(j.range[i]));
+        }
+    }
+
+    std::sort(j.length_completion.begin(), j.length_completion.end());
+
+    return j.generation == generation;
 }
 
 
-void CompletionStack::pop()
+void CompletionStack::calculate_length_completion(completion & c)
 {
-    if (completion_count > 1)
-        --completion_count;
+    c.length_completion.clear();
+    c.length_completion.reserve(c.standard_completion.size());
+    for (auto const & i : c.standard_completion)
+        c.length_completion.push_back(matchmaker::as_longest(i));
+    std::sort(c.length_completion.begin(), c.length_completion.end());
+    c.length_completion_pending = false;
 }
 
 
 void CompletionStack::clear_top()
 {
+    reset_top();
+
+    if (completion_count == 1)
+    {
+        // use entire dictionary for completions, the previous library's words may not be valid anymore
+        root_words.reset();
+        queued.clear();
+        post_root_job();
+    }
+
+    account_memory();
+}
+
+
+bool CompletionStack::refilter(TaskProgress & progress)
+{
+    auto words = std::make_shared<std::vector<int>>();
+    if (!filter_dictionary(wf, matchmaker::count(), *words, &progress))
+        return false;
+
+    completion_count = 1;
+    reset_top();
+    set_root(std::move(words));
+    if (!push_queued_input())
+    {
+        update_length_completion();
+        account_memory();
+    }
+
+    return true;
+}
+
+
+void CompletionStack::set_root(std::shared_ptr<std::vector<int> const> words)
+{
+    root_words = std::move(words);
+    completions[0].standard_completion = *root_words;
+    completions[0].standard_completion_pending = false;
+}
+
+
+bool CompletionStack::push_queued_input()
+{
+    if (queued.empty())
+        return false;
+
+    std::string input;
+    input.swap(queued);
+
+    int const old_count = completion_count;
+    push(input.data(), (int) input.length());
+
+    return completion_count != old_count;
+}
+
+
+std::vector<int> const & CompletionStack::latest_length_completion() const
+{
+    for (int level = completion_count - 1; level > 0; --level)
+        if (!completions[level].length_completion_pending)
+            return completions[level].length_completion;
+
+    return completions[0].length_completion;
+}
+
+
+void CompletionStack::account_memory()
+{
+    using memory_accounting::heap_bytes;
+
+    uint64_t bytes{sizeof(CompletionStack)};
+    if (root_words)
+        bytes += heap_bytes(*root_words);
+    for (auto const & c : completions)
+        bytes += heap_bytes(c.prefix) + heap_bytes(c.length_completion);
+    bytes += heap_bytes(queued);
+
+    {
+        // a job's words are usually the root's words, only a rebuilt root not yet collected adds to them
+        std::lock_guard<std::mutex> lock{worker_mutex};
+        for (job const * j : {&posted, &finished})
+        {
+            bytes += heap_bytes(j->length_completion);
+            if (j->words && j->words != root_words)
+                bytes += heap_bytes(*j->words);
+        }
+    }
+
+    memory.set(bytes);
+}
+
+
+void CompletionStack::reset_top()
+{
+    ++generation;
+
     top().prefix.clear();
-    top().standard_completion.clear();
+    top().standard_completion = {};
+    top().standard_completion_pending = false;
     top().display_start = 0;
     top().len_display_start = 0;
     top().length_completion.clear();
+    top().length_completion_pending = false;
     top().ord_sum_display_start = 0;
     top().syn_display_start = 0;
     top().ant_display_start = 0;
+}
 
-    if (completion_count == 1)
+
+bool CompletionStack::filter_dictionary(
+    word_filter const & f,
+    int count,
+    std::vector<int> & words,
+    TaskProgress * progress
+)
+{
+    if (nullptr != progress)
+        progress->set_total(count);
+
+    // chunks are filtered in parallel, then joined in order
+    std::vector<std::future<std::vector<int>>> chunks;
+    for (int chunk = 0; chunk < count; chunk += FILTER_CHUNK)
     {
-        // use entire dictionary for completions
+        chunks.push_back(
+            thread_pool::submit(
+                thread_pool::INTERACTIVE,
+                [&f, progress, chunk, end = std::min(chunk + FILTER_CHUNK, count)]()
+                {
+                    std::vector<int> passed;
+
+                    auto library_lock = matchmaker::lock_library();
+                    if (!library_lock.owns_lock())
+                        return passed;
+
+                    if (nullptr != progress && progress->cancelled())
+                        return passed;
+
+                    for (int i = chunk; i < end; ++i)
+                        if (f.passes(i))
+                            passed.push_back(i);
+
+                    if (nullptr != progress)
+                        progress->advance(end - chunk);
+
+                    return passed;
+                }
+            )
+        );
+    }
+
+    words.clear();
+    words.reserve(count);
+    for (auto & chunk : chunks)
+    {
+        auto const passed = thread_pool::get(chunk);
+        words.insert(words.end(), passed.begin(), passed.end());
+    }
 
-        top().standard_completion.reserve(matchmaker::count());
-        for (int i = 0; i < matchmaker::count(); ++i)
-            if (wf.passes(i))
-                top().standard_completion.push_back(i);
+    return nullptr == progress || !progress->cancelled();
+}
+
+
+int CompletionStack::common_prefix_length() const
+{
+    auto const & c = top();
+    int const prefix_len = (int) c.prefix.length();
+
+    if (c.standard_completion.size() == 0)
+        return prefix_len;
+
+    int first_entry_len{0};
+    char const * first_entry = matchmaker::at(c.standard_completion[0], &first_entry_len);
 
-        top().length_completion.reserve(top().standard_completion.size());
-        std::make_heap(top().length_completion.begin(), top().length_completion.end());
-        for (auto const & i : top().standard_completion)
+    // find out the "target_completion_count" or the completion count after skipping
+    // by common characters
+    int target_completion_count = completion_count - 1;
+    bool ok = first_entry_len > prefix_len;
+    while (ok)
+    {
+        for (auto i : c.standard_completion)
         {
-            top().length_completion.push_back(matchmaker::as_longest(i));
-            std::push_heap(top().length_completion.begin(), top().length_completion.end());
+            int entry_len{0};
+            char const * entry = matchmaker::at(i, &entry_len);
+
+            // are entry and first_entry long enough to compare at target_completion_count?
+            if (entry_len <= target_completion_count)
+                ok = false;
+            else if (first_entry_len <= target_completion_count)
+                ok = false;
+
+            else if (entry[target_completion_count] != first_entry[target_completion_count])
+                ok = false;
         }
-        std::sort_heap(top().length_completion.begin(), top().length_completion.end());
+
+        if (ok)
+            ++target_completion_count;
     }
+
+    return std::max(prefix_len, std::min(target_completion_count, first_entry_len));
 }
 
 
@@ -1,11 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <string>
 #include <vector>
 
 #include <matchable/matchable_fwd.h>
 
+#include "memory_accounting.h"
 
+
+class TaskProgress;
 struct word_filter;
 
 
@@ -13,6 +22,12 @@ struct word_filter;
  * The CompletionStack class provides the data for everything that is seen in the various views under
  * the "completable" tab. The stack consists of "completion" structs, with each representing the letters
  * making up a word as typed so far (completion.prefix).
+ *
+ * The root completion (all words passing the filter) and length completions for large completions are
+ * calculated in the background (a thread_pool task) so that input handling never waits on dictionary size.
+ * Every level's standard completion is a range of the root's words, so pushing a letter copies nothing.
+ * Every change to the top of the stack starts a new generation, which cooperatively cancels any calculation
+ * started for an older generation.
  */
 class CompletionStack
 {
@@ -24,13 +39,21 @@ public:
         // user input state
         std::string prefix;
 
-        std::vector<int> standard_completion;
+        // a range of the root's words, valid until the root is rebuilt
+        std::span<int const> standard_completion;
+
+        // true while the background worker filters the dictionary for the root, which is empty meanwhile
+        bool standard_completion_pending{false};
 
         // first index displayed for standard_completion
         int display_start{0};
 
         std::vector<int> length_completion;
 
+        // true while length_completion is not yet calculated, either because this level is below the
+        // top (see push(char const *, int)) or because the background worker is calculating it
+        bool length_completion_pending{false};
+
         // first index displayed for length_completion
         int len_display_start{0};
 
@@ -45,18 +68,40 @@ public:
     };
 
     CompletionStack(word_filter const &);
+    CompletionStack(CompletionStack const &) = delete;
+    CompletionStack & operator=(CompletionStack const &) = delete;
+    ~CompletionStack();
 
     /**
-     * Add a letter (character) to the stack if doing so would make an known word
+     * Add a letter (character) to the stack if doing so would make an known word. While the root is
+     * pending the letter is queued instead, see queued_input()
      * @param[in] ch Character to push onto the stack
      */
     void push(int ch);
 
     /**
-     * Removes the last letter (character) if any present
+     * Add letters (characters) to the stack one by one, skipping those that would make an unknown word.
+     * Each new level is sliced from the previous one, and length completion is only calculated for the
+     * resulting top, with the levels in between calculating theirs once they become top again (see pop())
+     *
+     * @param[in] chars Characters to push onto the stack
+     * @param[in] count Number of characters to push
+     */
+    void push(char const * chars, int count);
+
+    /**
+     * Removes the last letter (character) if any present, queued letters first
      */
     void pop();
 
+    /**
+     * Letters typed while the root is pending have nothing to be sliced from yet, so they are kept here
+     * and pushed as soon as the root arrives (see collect() and refilter())
+     *
+     * @returns The letters waiting for the root, following top().prefix
+     */
+    std::string const & queued_input() const { return queued; }
+
     /**
      * The stack's count is always at least 1, since an empty prefix is a completion with all words.
      * Generally, the stack's count is always one more than top().prefix.length()
@@ -72,7 +117,25 @@ public:
     completion & top() { return completions[completion_count - 1]; }
 
     /**
-     * clear the completion data for the latest completion
+     * @returns top().length_completion, or while that is pending the length completion of the closest
+     *     level below that has one, so that the previous results stay visible meanwhile
+     */
+    std::vector<int> const & latest_length_completion() const;
+
+    /**
+     * @returns A number that changes whenever the top of the stack or its data changes
+     */
+    uint64_t get_generation() const { return generation; }
+
+    /**
+     * @returns The length of the prefix shared by all words of top().standard_completion, which is at
+     *     least top().prefix.length()
+     */
+    int common_prefix_length() const;
+
+    /**
+     * clear the completion data for the latest completion. Clearing the root has the background worker
+     * filter the dictionary again, see collect()
      */
     void clear_top();
 
@@ -81,10 +144,95 @@ public:
      */
     void clear_all();
 
+    /**
+     * Apply a changed filter: the stack is reduced to a single completion with all words passing the
+     * filter. The stack is only changed if the filtering runs to completion
+     *
+     * @param[in] progress Receives the number of words filtered and is checked for cancellation
+     * @returns true if the filter was applied, false if cancelled
+     */
+    bool refilter(TaskProgress & progress);
+
+    /**
+     * Move a root or length completion finished by the background worker onto the top of the stack.
+     * Results for anything other than the current top are discarded
+     *
+     * @returns true if top().length_completion, and for a rebuilt root top().standard_completion, was updated
+     */
+    bool collect();
+
 
 private:
+    // add a level without calculating its length completion, returns false if the push was ignored
+    bool grow(int ch);
+
+    // reset the fields of the latest completion
+    void reset_top();
+
+    // collect all words passing the filter, returns false if cancelled through progress
+    static bool filter_dictionary(word_filter const & f, int count, std::vector<int> & words, TaskProgress * progress);
+
+    // make words the root's words, with all levels above the root cleared
+    void set_root(std::shared_ptr<std::vector<int> const> words);
+
+    // push the letters queued while the root was pending, returns false if none were pushed
+    bool push_queued_input();
+
+    // calculate top().length_completion now if small enough, otherwise hand it to the worker
+    void update_length_completion();
+
+    // have the worker filter the dictionary for the root and calculate its length completion
+    void post_root_job();
+
+    static void calculate_length_completion(completion &);
+
+    // report the bytes held by all levels, including those above the top, and by the worker's jobs
+    void account_memory();
+
+    // background worker
+    struct job
+    {
+        uint64_t generation{0};
+        int level{0};
+
+        // filter the dictionary into words first, a root job
+        std::shared_ptr<word_filter const> filter;
+
+        // shared with the stack rather than copied, see standard_completion
+        std::shared_ptr<std::vector<int> const> words;
+        std::span<int const> range;
+
+        std::vector<int> length_completion;
+    };
+
+    // replace whatever job is posted but not yet taken by the worker, and make sure the worker runs
+    void post_job(job j);
+
+    void work();
+    bool calculate(job &) const;
+
     completion completions[CAPACITY];
     int completion_count{1};
 
+    // all words passing the filter, the standard completions of all levels are ranges of it
+    std::shared_ptr<std::vector<int> const> root_words;
+
+    // see queued_input()
+    std::string queued;
+
     word_filter const & wf;
+
+    // incremented whenever the top of the stack or its data changes
+    std::atomic<uint64_t> generation{0};
+
+    std::mutex worker_mutex;
+    std::condition_variable worker_cv;
+    job posted;                     // guarded by worker_mutex
+    bool job_posted{false};         // guarded by worker_mutex
+    job finished;                   // guarded by worker_mutex
+    bool job_finished{false};       // guarded by worker_mutex
+    bool stopping{false};           // guarded by worker_mutex
+    bool worker_scheduled{false};   // guarded by worker_mutex, true while work() is queued or running
+
+    memory_accounting::account memory{memory_accounting::COMPLETION_STACK};
 };
@@ -8,12 +8,17 @@
 
 
 
-std::string CompletionWindow::title()
+void CompletionWindow::title(std::string & t)
 {
-    std::string t{"Completion ("};
+    if (cs.top().standard_completion_pending)
+    {
+        t = "Completion (pending)";
+        return;
+    }
+
+    t = "Completion (";
     t += std::to_string(cs.top().standard_completion.size());
     t += ")";
-    return t;
 }
 
 
@@ -12,11 +12,14 @@ class CompletionWindow : public AbstractListWindow
     using AbstractListWindow::AbstractListWindow;
 
     // resolved AbstractWindow dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
 
     // resolved AbstractListWindow dependencies
     int & display_start() final;
     void unfiltered_words(int, int const * *, int *) const final;
     bool apply_filter() const final { return false; }
+
+    // AbstractListWindow options
+    bool uses_selection() const final { return false; }
 };
@@ -0,0 +1,122 @@
+#include "CursesRenderer.h"
+
+#include <algorithm>
+
+#include <ncurses.h>
+
+
+
+namespace
+{
+    chtype to_chtype(int ch)
+    {
+        switch (ch)
+        {
+            case Surface::ULCORNER : return ACS_ULCORNER;
+            case Surface::URCORNER : return ACS_URCORNER;
+            case Surface::LLCORNER : return ACS_LLCORNER;
+            case Surface::LRCORNER : return ACS_LRCORNER;
+            case Surface::HLINE    : return ACS_HLINE;
+            case Surface::VLINE    : return ACS_VLINE;
+            case Surface::LTEE     : return ACS_LTEE;
+            case Surface::RTEE     : return ACS_RTEE;
+        }
+
+        return (chtype) ch;
+    }
+
+
+    int from_chtype(chtype c)
+    {
+        chtype const glyph = c & (A_CHARTEXT | A_ALTCHARSET);
+        for (int g = Surface::ULCORNER; g <= Surface::RTEE; ++g)
+            if (glyph == (to_chtype(g) & (A_CHARTEXT | A_ALTCHARSET)))
+                return g;
+
+        return (int) (c & A_CHARTEXT);
+    }
+
+
+    attr_t to_attr(Surface::attribute a)
+    {
+        attr_t attr{A_NORMAL};
+        if (a & Surface::REVERSE)
+            attr |= A_REVERSE;
+        if (a & Surface::BOLD)
+            attr |= A_BOLD;
+
+        return attr;
+    }
+
+
+    class CursesSurface : public Surface
+    {
+    public:
+        explicit CursesSurface(WINDOW * win) : w{win} {}
+        ~CursesSurface() override { delwin(w); }
+
+        void put(int y, int x, int ch) override { mvwaddch(w, y, x, to_chtype(ch)); }
+        void put_string(int y, int x, std::string_view s) override
+        {
+            // clipped instead of wrapped to the next row
+            int const room = getmaxx(w) - x;
+            if (room > 0)
+                mvwaddnstr(w, y, x, s.data(), std::min((int) s.length(), room));
+        }
+        void fill(int y, int x, int ch, int count) override { mvwhline(w, y, x, to_chtype(ch), count); }
+        int char_at(int y, int x) const override { return from_chtype(mvwinch(w, y, x)); }
+
+        void attribute_on(attribute a) override { wattron(w, to_attr(a)); }
+        void attribute_off(attribute a) override { wattroff(w, to_attr(a)); }
+
+        void clear() override { wclear(w); }
+        void draw_border() override { box(w, 0, 0); }
+
+        void scroll_region(int top, int bottom, int lines) override
+        {
+            int const height = getmaxy(w);
+
+            // let doupdate() use the terminal's scrolling for the shifted rows
+            idlok(w, TRUE);
+            wsetscrreg(w, top, bottom);
+            scrollok(w, TRUE);
+            wscrl(w, lines);
+            scrollok(w, FALSE);
+            wsetscrreg(w, 0, height - 1);
+        }
+
+        bool resize(int height, int width) override { return wresize(w, height, width) != ERR; }
+        bool move_to(int y, int x) override { return mvwin(w, y, x) != ERR; }
+
+        void touch() override { touchwin(w); }
+        void stage() override { wnoutrefresh(w); }
+
+        WINDOW * input_window() const override { return w; }
+
+    private:
+        WINDOW * w;
+    };
+}
+
+
+
+std::unique_ptr<Surface> CursesRenderer::create_surface(int height, int width, int y, int x)
+{
+    WINDOW * win = newwin(height, width, y, x);
+    if (nullptr == win)
+        return nullptr;
+
+    return std::make_unique<CursesSurface>(win);
+}
+
+
+void CursesRenderer::flush()
+{
+    doupdate();
+}
+
+
+void CursesRenderer::get_size(int & rows, int & cols) const
+{
+    getmaxyx(stdscr, rows, cols);
+}
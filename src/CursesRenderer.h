@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Renderer.h"
+
+
+
+/**
+ * CursesRenderer draws with ncurses on stdscr, which must have been initialized (initscr() or newterm()).
+ * Surfaces are ncurses WINDOWs staged with wnoutrefresh(), and a flush is a single doupdate()
+ */
+class CursesRenderer : public Renderer
+{
+public:
+    CursesRenderer() = default;
+
+    std::unique_ptr<Surface> create_surface(int height, int width, int y, int x) override;
+    void flush() override;
+    void get_size(int & rows, int & cols) const override;
+};
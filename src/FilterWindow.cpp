@@ -50,14 +50,14 @@ FilterWindow::FilterWindow(CompletionStack & cs, WordStack & ws, InputWindow & i
     : AbstractCompletionDataWindow(cs, ws)
     , input_win(iw)
     , wf(f)
+    , applied_filter{std::make_shared<word_filter>(f)}
 {
 }
 
 
-std::string FilterWindow::title()
+void FilterWindow::title(std::string & t)
 {
-    static std::string const t{"Filter"};
-    return t;
+    t = "Filter";
 }
 
 
@@ -72,26 +72,38 @@ void FilterWindow::resize_hook()
 
 void FilterWindow::post_resize_hook()
 {
-    keypad(w, true);
+    if (nullptr != get_WINDOW())
+        keypad(get_WINDOW(), true);
 }
 
 
 void FilterWindow::pre_disable_hook()
 {
     auto long_task =
-        [&]()
+        [&](TaskProgress & progress)
         {
+            if (!cs.refilter(progress))
+                return false;
+
             // clear out the word stack
             while (!ws.empty())
                 ws.pop();
 
-            // clear out completion stack
-            while (cs.count() > 1)
-                cs.pop();
-            cs.clear_top();
+            return true;
         };
 
-    exec_long_task_with_busy_animation(long_task, *this);
+    if (exec_long_task("filter", long_task, *this))
+    {
+        *applied_filter = wf;
+    }
+    else
+    {
+        // completions still match the previous filter, so go back to it
+        uint64_t const version = wf.version;
+        wf = *applied_filter;
+        wf.version = version + 1;
+    }
+
     input_win.mark_dirty();
 }
 
@@ -103,13 +115,13 @@ void FilterWindow::draw_hook()
 
     static std::string const filter_type{"filter type: "};
 
-    mvwprintw(w, top_margin - 2, indent - filter_type.length(), "%s", filter_type.c_str());
+    w->put_string(top_margin - 2, indent - filter_type.length(), filter_type);
 
     if (hover == -1)
-        wattron(w, A_BOLD);
-    mvwprintw(w, top_margin - 2, indent, "%s", wf.direction.as_string().c_str());
+        w->attribute_on(Surface::BOLD);
+    w->put_string(top_margin - 2, indent, wf.direction.as_string());
     if (hover == -1)
-        wattroff(w, A_BOLD);
+        w->attribute_off(Surface::BOLD);
 
     int i = 0;
     for (; i < (int) word_attribute::variants().size() && i + top_margin < height - 2; ++i)
@@ -118,30 +130,30 @@ void FilterWindow::draw_hook()
         std::string const & att_str = att.as_string();
 
         if (wf.attributes.is_set(att))
-            wattron(w, A_REVERSE);
+            w->attribute_on(Surface::REVERSE);
 
         if (hover == i)
-            wattron(w, A_BOLD);
+            w->attribute_on(Surface::BOLD);
 
         int j = 0;
         for (; j < (int) att_str.length() && j + indent < width - 2; ++j)
-            mvwaddch(w, i + top_margin, j + indent, att_str[j]);
+            w->put(i + top_margin, j + indent, att_str[j]);
 
         if (wf.attributes.is_set(att))
-            wattroff(w, A_REVERSE);
+            w->attribute_off(Surface::REVERSE);
 
         if (hover == i)
-            wattroff(w, A_BOLD);
+            w->attribute_off(Surface::BOLD);
 
         // blank out rest of line
         for (; j + indent < width - 2; ++j)
-            mvwaddch(w, i + top_margin, j + indent, ' ');
+            w->put(i + top_margin, j + indent, ' ');
     }
 
     // blank out remaining lines
     for (; i + top_margin < height - 2; ++i)
         for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + top_margin, j + 1, ' ');
+            w->put(i + top_margin, j + 1, ' ');
 }
 
 
@@ -175,10 +187,12 @@ void FilterWindow::on_RETURN()
         if (direction_index >= (int) filter_direction::variants().size())
             direction_index = 0;
         wf.direction = filter_direction::from_index(direction_index);
+        ++wf.version;
     }
     else if (hover >= 0)
     {
         wf.attributes.toggle(word_attribute::from_index(hover));
+        ++wf.version;
     }
     else
     {
@@ -32,6 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 
+#include <memory>
+
 #include "AbstractCompletionDataWindow.h"
 
 
@@ -50,7 +52,7 @@ public:
 
 private:
     // resolved dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
@@ -66,4 +68,7 @@ private:
     int hover{-1};
     InputWindow & input_win;
     word_filter & wf;
+
+    // the filter the completion stack was last filtered with, restored if refiltering is cancelled
+    std::shared_ptr<word_filter> applied_filter;
 };
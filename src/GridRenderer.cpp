@@ -0,0 +1,215 @@
+#include "GridRenderer.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+
+static GridRenderer::cell const BLANK{' ', Surface::NORMAL};
+
+
+class GridSurface : public Surface
+{
+public:
+    GridSurface(GridRenderer & r, int h, int w, int top, int left)
+        : renderer{r}
+        , height{h}
+        , width{w}
+        , y{top}
+        , x{left}
+        , cells(h * w, BLANK)
+    {
+    }
+
+    void put(int row, int col, int ch) override
+    {
+        if (row >= 0 && row < height && col >= 0 && col < width)
+            cells[row * width + col] = GridRenderer::cell{ch, attributes};
+    }
+
+    void put_string(int row, int col, std::string_view s) override
+    {
+        for (int i = 0; i < (int) s.length(); ++i)
+            put(row, col + i, s[i]);
+    }
+
+    void fill(int row, int col, int ch, int count) override
+    {
+        for (int i = 0; i < count; ++i)
+            put(row, col + i, ch);
+    }
+
+    int char_at(int row, int col) const override
+    {
+        if (row < 0 || row >= height || col < 0 || col >= width)
+            return ' ';
+
+        return cells[row * width + col].ch;
+    }
+
+    void attribute_on(attribute a) override { attributes |= a; }
+    void attribute_off(attribute a) override { attributes &= ~a; }
+
+    void clear() override { std::fill(cells.begin(), cells.end(), BLANK); }
+
+    void draw_border() override
+    {
+        int const saved = attributes;
+        attributes = NORMAL;
+
+        fill(0, 1, HLINE, width - 2);
+        fill(height - 1, 1, HLINE, width - 2);
+        for (int row = 1; row < height - 1; ++row)
+        {
+            put(row, 0, VLINE);
+            put(row, width - 1, VLINE);
+        }
+        put(0, 0, ULCORNER);
+        put(0, width - 1, URCORNER);
+        put(height - 1, 0, LLCORNER);
+        put(height - 1, width - 1, LRCORNER);
+
+        attributes = saved;
+    }
+
+    void scroll_region(int top, int bottom, int lines) override
+    {
+        top = std::max(top, 0);
+        bottom = std::min(bottom, height - 1);
+        for (int step = 0; step < std::abs(lines); ++step)
+        {
+            if (lines > 0)
+            {
+                std::copy(cells.begin() + (top + 1) * width, cells.begin() + (bottom + 1) * width,
+                          cells.begin() + top * width);
+                std::fill(cells.begin() + bottom * width, cells.begin() + (bottom + 1) * width, BLANK);
+            }
+            else
+            {
+                std::copy_backward(cells.begin() + top * width, cells.begin() + bottom * width,
+                                   cells.begin() + (bottom + 1) * width);
+                std::fill(cells.begin() + top * width, cells.begin() + (top + 1) * width, BLANK);
+            }
+        }
+    }
+
+    bool resize(int h, int w) override
+    {
+        std::vector<GridRenderer::cell> resized(h * w, BLANK);
+        for (int row = 0; row < std::min(h, height); ++row)
+            for (int col = 0; col < std::min(w, width); ++col)
+                resized[row * w + col] = cells[row * width + col];
+
+        cells.swap(resized);
+        height = h;
+        width = w;
+
+        return true;
+    }
+
+    bool move_to(int top, int left) override
+    {
+        y = top;
+        x = left;
+
+        return true;
+    }
+
+    // every stage copies the whole surface anyway
+    void touch() override {}
+
+    void stage() override { renderer.stage(cells, height, width, y, x); }
+
+private:
+    GridRenderer & renderer;
+    int height;
+    int width;
+    int y;
+    int x;
+    int attributes{NORMAL};
+    std::vector<GridRenderer::cell> cells;
+};
+
+
+
+GridRenderer::GridRenderer(int rows, int cols)
+{
+    set_size(rows, cols);
+}
+
+
+std::unique_ptr<Surface> GridRenderer::create_surface(int surface_height, int surface_width, int y, int x)
+{
+    if (surface_height <= 0 || surface_width <= 0)
+        return nullptr;
+
+    return std::make_unique<GridSurface>(*this, surface_height, surface_width, y, x);
+}
+
+
+void GridRenderer::flush()
+{
+    ++frames;
+
+    changed_cells = 0;
+    for (size_t i = 0; i < screen.size(); ++i)
+    {
+        if (screen[i] != staged[i])
+        {
+            screen[i] = staged[i];
+            ++changed_cells;
+        }
+    }
+}
+
+
+void GridRenderer::get_size(int & rows, int & cols) const
+{
+    rows = height;
+    cols = width;
+}
+
+
+void GridRenderer::set_size(int rows, int cols)
+{
+    height = rows;
+    width = cols;
+    staged.assign(rows * cols, BLANK);
+    screen.assign(rows * cols, BLANK);
+}
+
+
+std::string GridRenderer::row_text(int y) const
+{
+    std::string text;
+    text.reserve(width);
+    for (int x = 0; x < width; ++x)
+    {
+        switch (int const ch = at(y, x).ch)
+        {
+            case Surface::HLINE : text += '-'; break;
+            case Surface::VLINE : text += '|'; break;
+            default             : text += ch < 256 ? (char) ch : '+'; break;
+        }
+    }
+
+    return text;
+}
+
+
+void GridRenderer::stage(std::vector<cell> const & cells, int surface_height, int surface_width, int y, int x)
+{
+    for (int row = 0; row < surface_height; ++row)
+    {
+        int const screen_y = y + row;
+        if (screen_y < 0 || screen_y >= height)
+            continue;
+
+        for (int col = 0; col < surface_width; ++col)
+        {
+            int const screen_x = x + col;
+            if (screen_x >= 0 && screen_x < width)
+                staged[screen_y * width + screen_x] = cells[row * surface_width + col];
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+
+
+
+class GridSurface;
+
+
+/**
+ * GridRenderer draws into memory instead of a terminal: a grid of cells for the screen, which flush()
+ * updates from what the surfaces staged, the way doupdate() updates a terminal.
+ *
+ * Without a terminal drawing costs only what the windows compute, and frames can be compared cell by
+ * cell. Surfaces have no WINDOW, so nothing drawn with a GridRenderer reads keys.
+ */
+class GridRenderer : public Renderer
+{
+public:
+    struct cell
+    {
+        int ch;         // printable ascii or a Surface::glyph
+        int attributes; // Surface::attribute values combined with bitwise or
+
+        bool operator==(cell const &) const = default;
+    };
+
+    /**
+     * @param[in] rows The screen's height
+     * @param[in] cols The screen's width
+     */
+    GridRenderer(int rows, int cols);
+
+    std::unique_ptr<Surface> create_surface(int height, int width, int y, int x) override;
+    void flush() override;
+    void get_size(int & rows, int & cols) const override;
+
+    /**
+     * Change the screen's size, blanking it. Windows pick up the new size with their next resize
+     *
+     * @param[in] rows The screen's new height
+     * @param[in] cols The screen's new width
+     */
+    void set_size(int rows, int cols);
+
+    /**
+     * @param[in] y Row
+     * @param[in] x Column
+     * @returns The cell as of the last flush()
+     */
+    cell const & at(int y, int x) const { return screen[y * width + x]; }
+
+    /**
+     * @param[in] y Row
+     * @returns The row as of the last flush() as text, glyphs are drawn with '+', '-' and '|'
+     */
+    std::string row_text(int y) const;
+
+    /**
+     * @returns The number of flushes so far
+     */
+    uint64_t get_frames() const { return frames; }
+
+    /**
+     * @returns The number of cells that the last flush() changed, which a terminal would have been sent
+     */
+    uint64_t get_changed_cells() const { return changed_cells; }
+
+
+private:
+    friend GridSurface;
+
+    // copy a surface's cells onto the staged screen, clipped to the screen
+    void stage(std::vector<cell> const & cells, int surface_height, int surface_width, int y, int x);
+
+    int height;
+    int width;
+    std::vector<cell> staged;
+    std::vector<cell> screen;
+    uint64_t frames{0};
+    uint64_t changed_cells{0};
+};
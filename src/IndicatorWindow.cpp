@@ -40,10 +40,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 
-std::string IndicatorWindow::title()
+void IndicatorWindow::title(std::string & t)
 {
-    static std::string const t;
-    return t;
+    t.clear();
 }
 
 
@@ -75,38 +74,38 @@ void IndicatorWindow::draw_hook()
         {
             if (EnablednessSetting::Borders::grab().as_enabledness() == Enabledness::Enabled::grab())
             {
-                mvwaddch(w, 0, abbreviation_x - 2, ACS_ULCORNER);
-                mvwaddch(w, 0, abbreviation_x - 1, ACS_HLINE);
-                mvwaddch(w, 0, abbreviation_x, ACS_HLINE);
-                mvwaddch(w, 0, abbreviation_x + 1, ACS_HLINE);
-                mvwaddch(w, 0, abbreviation_x + 2, ACS_URCORNER);
-                mvwaddch(w, 1, abbreviation_x - 2, ACS_VLINE);
-                mvwaddch(w, 1, abbreviation_x + 2, ACS_VLINE);
-                mvwaddch(w, 2, abbreviation_x - 2, ACS_LLCORNER);
-                mvwaddch(w, 2, abbreviation_x - 1, ACS_HLINE);
-                mvwaddch(w, 2, abbreviation_x, ACS_HLINE);
-                mvwaddch(w, 2, abbreviation_x + 1, ACS_HLINE);
-                mvwaddch(w, 2, abbreviation_x + 2, ACS_LRCORNER);
+                w->put(0, abbreviation_x - 2, Surface::ULCORNER);
+                w->put(0, abbreviation_x - 1, Surface::HLINE);
+                w->put(0, abbreviation_x, Surface::HLINE);
+                w->put(0, abbreviation_x + 1, Surface::HLINE);
+                w->put(0, abbreviation_x + 2, Surface::URCORNER);
+                w->put(1, abbreviation_x - 2, Surface::VLINE);
+                w->put(1, abbreviation_x + 2, Surface::VLINE);
+                w->put(2, abbreviation_x - 2, Surface::LLCORNER);
+                w->put(2, abbreviation_x - 1, Surface::HLINE);
+                w->put(2, abbreviation_x, Surface::HLINE);
+                w->put(2, abbreviation_x + 1, Surface::HLINE);
+                w->put(2, abbreviation_x + 2, Surface::LRCORNER);
             }
             else
             {
-                wattron(w, A_REVERSE);
+                w->attribute_on(Surface::REVERSE);
             }
         }
         else
         {
-            mvwaddch(w, 0, abbreviation_x - 2, ' ');
-            mvwaddch(w, 0, abbreviation_x - 1, ' ');
-            mvwaddch(w, 0, abbreviation_x, ' ');
-            mvwaddch(w, 0, abbreviation_x + 1, ' ');
-            mvwaddch(w, 0, abbreviation_x + 2, ' ');
-            mvwaddch(w, 1, abbreviation_x - 2, ' ');
-            mvwaddch(w, 1, abbreviation_x + 2, ' ');
-            mvwaddch(w, 2, abbreviation_x - 2, ' ');
-            mvwaddch(w, 2, abbreviation_x - 1, ' ');
-            mvwaddch(w, 2, abbreviation_x, ' ');
-            mvwaddch(w, 2, abbreviation_x + 1, ' ');
-            mvwaddch(w, 2, abbreviation_x + 2, ' ');
+            w->put(0, abbreviation_x - 2, ' ');
+            w->put(0, abbreviation_x - 1, ' ');
+            w->put(0, abbreviation_x, ' ');
+            w->put(0, abbreviation_x + 1, ' ');
+            w->put(0, abbreviation_x + 2, ' ');
+            w->put(1, abbreviation_x - 2, ' ');
+            w->put(1, abbreviation_x + 2, ' ');
+            w->put(2, abbreviation_x - 2, ' ');
+            w->put(2, abbreviation_x - 1, ' ');
+            w->put(2, abbreviation_x, ' ');
+            w->put(2, abbreviation_x + 1, ' ');
+            w->put(2, abbreviation_x + 2, ' ');
         }
 
         char abbreviation = 'X';
@@ -116,8 +115,8 @@ void IndicatorWindow::draw_hook()
         if (abbreviation >= 'a' && abbreviation <= 'z')
             abbreviation -= 'a' - 'A';
 
-        mvwaddch(w, 1, abbreviation_x, abbreviation);
-        wattroff(w, A_REVERSE);
+        w->put(1, abbreviation_x, abbreviation);
+        w->attribute_off(Surface::REVERSE);
     }
 }
 
@@ -45,7 +45,7 @@ class IndicatorWindow : public AbstractWindow
     using AbstractWindow::AbstractWindow;
 
     // resolved dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
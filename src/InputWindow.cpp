@@ -39,10 +39,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 
-std::string InputWindow::title()
+void InputWindow::title(std::string & t)
 {
-    static std::string const t{"press ',' for help"};
-    return t;
+    t = "press ',' for help";
 }
 
 
@@ -58,14 +57,19 @@ void InputWindow::resize_hook()
 void InputWindow::draw_hook()
 {
     std::string const & prefix = cs.top().prefix;
+    std::string const & queued = cs.queued_input();
 
     int x = 0;
     for (; x < width - 2 && x < (int) prefix.size(); ++x)
-        mvwaddch(w, 1, x + 1, prefix[x]);
+        w->put(1, x + 1, prefix[x]);
+
+    // typed while the root is pending, see CompletionStack::queued_input()
+    for (int q = 0; x < width - 2 && q < (int) queued.size(); ++x, ++q)
+        w->put(1, x + 1, queued[q]);
 
     // blank out rest of line
     for (; x < width - 2; ++x)
-        mvwaddch(w, 1, x + 1, ' ');
+        w->put(1, x + 1, ' ');
 }
 
 
@@ -42,7 +42,7 @@ class InputWindow : public AbstractCompletionDataWindow
 {
     using AbstractCompletionDataWindow::AbstractCompletionDataWindow;
 
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
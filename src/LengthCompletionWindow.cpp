@@ -55,10 +55,9 @@ LengthCompletionWindow::LengthCompletionWindow(
 }
 
 
-std::string LengthCompletionWindow::title()
+void LengthCompletionWindow::title(std::string & t)
 {
-    static std::string const t{"Length Completion"};
-    return t;
+    t = cs.top().length_completion_pending ? "Length Completion (pending)" : "Length Completion";
 }
 
 
@@ -79,8 +78,10 @@ int & LengthCompletionWindow::display_start()
 
 void LengthCompletionWindow::unfiltered_words(int, int const * * words, int * count) const
 {
-    *words = cs.top().length_completion.data();
-    *count = (int) cs.top().length_completion.size();
+    // while pending, the closest level below that has its length completion shows meanwhile
+    auto const & length_completion = cs.latest_length_completion();
+    *words = length_completion.data();
+    *count = (int) length_completion.size();
 }
 
 
@@ -57,7 +57,7 @@ public:
 
 private:
     // resolved AbstractWindow dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
 
     // resolved AbstractListWindow dependencies
@@ -67,6 +67,7 @@ private:
 
     // AbstractListWindow options
     char const * string_from_index(int, int *) final;
+    bool uses_selection() const final { return false; }
 
     CompletionWindow const & completion_win;
 };
@@ -65,10 +65,9 @@ static std::vector<std::string> const content =
 
 
 
-std::string MatchmakerHelpWindow::title()
+void MatchmakerHelpWindow::title(std::string & t)
 {
-    static std::string const t{"Help"};
-    return t;
+    t = "Help";
 }
 
 
@@ -102,17 +101,17 @@ void MatchmakerHelpWindow::draw_hook()
 
         int j = 0;
         for (; j < (int) line.size() && j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, line[j]);
+            w->put(i + 1, j + 1, line[j]);
 
         // blank out rest of line
         for (; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
     }
 
     // blank out remaining lines
     for (; i < height - 2; ++i)
         for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
 }
 
 
@@ -23,10 +23,9 @@ MatchmakerLocationWindow::MatchmakerLocationWindow(MatchmakerSelectionWindow & s
 }
 
 
-std::string MatchmakerLocationWindow::title()
+void MatchmakerLocationWindow::title(std::string & t)
 {
-    static std::string const t{"search location"};
-    return t;
+    t = "search location";
 }
 
 
@@ -44,16 +43,16 @@ void MatchmakerLocationWindow::draw_hook()
 {
     if (EnablednessSetting::Borders::grab().as_enabledness() == Enabledness::Enabled::grab())
     {
-        mvwaddch(w, height - 1, 0, ACS_LTEE);
-        mvwaddch(w, height - 1, width - 1, ACS_RTEE);
+        w->put(height - 1, 0, Surface::LTEE);
+        w->put(height - 1, width - 1, Surface::RTEE);
     }
 
     int i = 0;
     for (; i < (int) search_prefix.size() && i < width - 2; ++i)
-        mvwaddch(w, 1, i + 1, search_prefix[i]);
+        w->put(1, i + 1, search_prefix[i]);
 
     for (; i < width - 2; ++i)
-        mvwaddch(w, 1, i + 1, ' ');
+        w->put(1, i + 1, ' ');
 }
 
 
@@ -65,14 +64,24 @@ Layer::Type MatchmakerLocationWindow::layer() const
 
 void MatchmakerLocationWindow::on_TAB()
 {
-    exec_long_task_with_busy_animation(
-        [&]()
+    exec_long_task(
+        "library scan",
+        [&](TaskProgress & progress)
         {
+            // the number of entries is unknown up front, so only entries visited are reported
+            bool completed = true;
             std::vector<std::string> dictionaries;
             try
             {
                 for (auto const & entry : std::filesystem::recursive_directory_iterator(search_prefix))
                 {
+                    if (progress.cancelled())
+                    {
+                        completed = false;
+                        break;
+                    }
+                    progress.advance();
+
                     if (entry.is_regular_file())
                     {
                         if (strcmp(entry.path().filename().c_str(), "libmatchmaker.so") == 0)
@@ -85,7 +94,10 @@ void MatchmakerLocationWindow::on_TAB()
             }
             catch (std::filesystem::__cxx11::filesystem_error const &) {}
 
+            // a cancelled scan still offers what it found so far
             mm_sel_win.set_content(dictionaries);
+
+            return completed;
         },
         mm_sel_win
     );
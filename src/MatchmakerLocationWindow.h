@@ -19,7 +19,7 @@ public:
 
 private:
     // resolved dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
@@ -23,10 +23,9 @@ void MatchmakerSelectionWindow::set_content(std::vector<std::string> new_content
 }
 
 
-std::string MatchmakerSelectionWindow::title()
+void MatchmakerSelectionWindow::title(std::string & t)
 {
-    static std::string const t{""};
-    return t;
+    t.clear();
 }
 
 
@@ -44,9 +43,9 @@ void MatchmakerSelectionWindow::draw_hook()
 {
     if (EnablednessSetting::Borders::grab().as_enabledness() == Enabledness::Enabled::grab())
     {
-        box(w, 0, 0);
-        mvwaddch(w, 0, 0, ACS_LTEE);
-        mvwaddch(w, 0, width - 1, ACS_RTEE);
+        w->draw_border();
+        w->put(0, 0, Surface::LTEE);
+        w->put(0, width - 1, Surface::RTEE);
     }
 
     int display_count = (int) content.size() - selected;
@@ -57,23 +56,23 @@ void MatchmakerSelectionWindow::draw_hook()
         std::string dictionary = content[selected + i];
 
         if (i == 0)
-            wattron(w, A_REVERSE);
+            w->attribute_on(Surface::REVERSE);
 
         int j = 0;
         for (; j < (int) dictionary.length() && j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, dictionary[j]);
+            w->put(i + 1, j + 1, dictionary[j]);
 
-        wattroff(w, A_REVERSE);
+        w->attribute_off(Surface::REVERSE);
 
         // blank out rest of line
         for (; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
     }
 
     // blank out remaining lines
     for (; i < height - 2; ++i)
         for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
 }
 
 
@@ -87,10 +86,27 @@ void MatchmakerSelectionWindow::load_currently_selected()
 {
     if (content.size() > 0)
     {
-        exec_long_task_with_busy_animation(
-            [&]() { matchmaker::set_library(content.at(selected).c_str()); },
+        exec_long_task(
+            "library load",
+            [&](TaskProgress & progress)
+            {
+                matchmaker::load_library(content.at(selected).c_str());
+
+                // loading itself cannot be interrupted, a cancelled load ends up without a library
+                if (progress.cancelled())
+                {
+                    matchmaker::unset_library();
+                    return false;
+                }
+
+                progress.advance();
+                return true;
+            },
             *this
         );
+
+        // observers update the UI so they are informed here, back on the main thread
+        matchmaker::publish_library_state();
         mark_dirty();
     }
 }
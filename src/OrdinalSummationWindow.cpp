@@ -24,9 +24,9 @@ OrdinalSummationWindow::OrdinalSummationWindow(
 }
 
 
-std::string OrdinalSummationWindow::title()
+void OrdinalSummationWindow::title(std::string & t)
 {
-    std::string t{"Ordinal Summation: "};
+    t = "Ordinal Summation: ";
 
     auto const & completion = cs.top().standard_completion;
     if (completion.size() > 0)
@@ -35,11 +35,8 @@ std::string OrdinalSummationWindow::title()
         t += "0";
 
     t += "  (";
-    auto os = get_words();
-    t += std::to_string(os.size());
+    t += std::to_string(get_words().size());
     t += ")";
-
-    return t;
 }
 
 
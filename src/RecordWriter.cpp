@@ -0,0 +1,193 @@
+#include "RecordWriter.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "matchmaker.h"
+
+
+
+RecordWriter::RecordWriter(std::ostream & out) : out{out}
+{
+}
+
+
+void RecordWriter::set_format(output_format::Type f)
+{
+    format = f;
+    described.clear();
+}
+
+
+void RecordWriter::begin(char const * type)
+{
+    record.clear();
+    header.clear();
+    record_type = type;
+
+    if (format == output_format::json::grab())
+    {
+        record += "{\"type\":";
+        quoted(type);
+    }
+    else
+    {
+        header += '#';
+        header += type;
+        record += type;
+    }
+}
+
+
+void RecordWriter::int_field(char const * k, int64_t value)
+{
+    key(k);
+
+    char digits[24];
+    auto const [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+    (void) ec; // 24 characters always suffice
+    record.append(digits, end);
+}
+
+
+void RecordWriter::bool_field(char const * k, bool value)
+{
+    key(k);
+
+    if (format == output_format::json::grab())
+        record += value ? "true" : "false";
+    else
+        record += value ? '1' : '0';
+}
+
+
+void RecordWriter::string_field(char const * k, std::string_view value)
+{
+    key(k);
+    quoted(value);
+}
+
+
+void RecordWriter::term_list(char const * k, int const * terms, int count)
+{
+    begin_list(k);
+    for (int i = 0; i < count; ++i)
+    {
+        int length{0};
+        char const * term = matchmaker::at(terms[i], &length);
+        list_item(std::string_view{term, (size_t) length});
+    }
+    end_list();
+}
+
+
+void RecordWriter::begin_list(char const * k)
+{
+    key(k);
+    list_items = 0;
+
+    if (format == output_format::json::grab())
+        record += '[';
+}
+
+
+void RecordWriter::list_item(std::string_view value)
+{
+    if (list_items++ > 0)
+        record += ',';
+
+    quoted(value);
+}
+
+
+void RecordWriter::end_list()
+{
+    if (format == output_format::json::grab())
+        record += ']';
+}
+
+
+void RecordWriter::end()
+{
+    if (format == output_format::json::grab())
+    {
+        record += "}\n";
+    }
+    else
+    {
+        record += '\n';
+        if (std::find(described.begin(), described.end(), record_type) == described.end())
+        {
+            described.push_back(record_type);
+            header += '\n';
+            out.rdbuf()->sputn(header.data(), header.size());
+        }
+    }
+
+    out.rdbuf()->sputn(record.data(), record.size());
+}
+
+
+void RecordWriter::key(char const * k)
+{
+    if (format == output_format::json::grab())
+    {
+        record += ',';
+        quoted(k);
+        record += ':';
+    }
+    else
+    {
+        header += '\t';
+        header += k;
+        record += '\t';
+    }
+}
+
+
+void RecordWriter::quoted(std::string_view value)
+{
+    static char const * const HEX{"0123456789abcdef"};
+
+    if (format == output_format::json::grab())
+    {
+        record += '"';
+        for (char ch : value)
+        {
+            switch (ch)
+            {
+                case '"'  : record += "\\\""; break;
+                case '\\' : record += "\\\\"; break;
+                case '\n' : record += "\\n";  break;
+                case '\t' : record += "\\t";  break;
+                case '\r' : record += "\\r";  break;
+                default:
+                    if ((unsigned char) ch < 0x20)
+                    {
+                        record += "\\u00";
+                        record += HEX[(ch >> 4) & 0xf];
+                        record += HEX[ch & 0xf];
+                    }
+                    else
+                    {
+                        record += ch;
+                    }
+            }
+        }
+        record += '"';
+    }
+    else
+    {
+        for (char ch : value)
+        {
+            switch (ch)
+            {
+                case '\\' : record += "\\\\"; break;
+                case '\n' : record += "\\n";  break;
+                case '\t' : record += "\\t";  break;
+                case ','  : record += "\\,";  break;
+                default   : record += ch;
+            }
+        }
+    }
+}
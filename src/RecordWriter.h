@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <matchable/matchable.h>
+
+
+MATCHABLE(output_format, text, json, tsv)
+
+
+/**
+ * RecordWriter formats the shell's results as machine-readable records, one per line, and hands each
+ * finished record to the stream's buffer with a single write, so that no padding or per-value stream
+ * formatting is involved.
+ *
+ * json: one object per line (JSON Lines), for example {"type":"lookup","index":7,"word":"abc"}
+ *
+ * tsv: tab separated values in the order the fields were added. The first record of every type since
+ * the last set_format() is preceded by a header line starting with '#', naming the type and its fields.
+ * List items are separated by ','. Backslashes, tabs, newlines and commas within values are escaped
+ * with a backslash.
+ *
+ * The text format has no records, callers keep printing their own decorated output.
+ */
+class RecordWriter
+{
+public:
+    RecordWriter(RecordWriter const &) = delete;
+    RecordWriter & operator=(RecordWriter const &) = delete;
+
+    /**
+     * @param[in] out Where finished records are written, which should be buffered
+     */
+    explicit RecordWriter(std::ostream & out);
+
+    void set_format(output_format::Type f);
+    output_format::Type get_format() const { return format; }
+
+    /**
+     * Start a record, see end()
+     *
+     * @param[in] type The kind of record, written first
+     */
+    void begin(char const * type);
+
+    void int_field(char const * key, int64_t value);
+    void bool_field(char const * key, bool value);
+    void string_field(char const * key, std::string_view value);
+
+    /**
+     * Add a list of dictionary terms as their strings
+     *
+     * @param[in] key The field's name
+     * @param[in] terms Indexes of the terms
+     * @param[in] count Number of terms
+     */
+    void term_list(char const * key, int const * terms, int count);
+
+    /**
+     * Add a list of strings, see list_item() and end_list()
+     *
+     * @param[in] key The field's name
+     */
+    void begin_list(char const * key);
+    void list_item(std::string_view value);
+    void end_list();
+
+    /**
+     * Finish the record and write it to the stream
+     */
+    void end();
+
+
+private:
+    void key(char const * k);
+    void quoted(std::string_view value);
+
+    std::ostream & out;
+    output_format::Type format{output_format::text::grab()};
+
+    // the record being assembled and, for tsv, its header
+    std::string record;
+    std::string header;
+    std::string record_type;
+    int list_items{0};
+
+    // record types whose tsv header was already written
+    std::vector<std::string> described;
+};
@@ -0,0 +1,25 @@
+#include "Renderer.h"
+
+#include "CursesRenderer.h"
+
+
+
+// static variable for the renderer in use (look like a function but its a variable)
+static Renderer * & current() { static Renderer * r{nullptr}; return r; }
+
+
+Renderer & Renderer::get()
+{
+    static CursesRenderer curses;
+
+    if (nullptr == current())
+        return curses;
+
+    return *current();
+}
+
+
+void Renderer::set(Renderer * r)
+{
+    current() = r;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+
+// ncurses window
+typedef struct _win_st WINDOW;
+
+
+/**
+ * Surface is the drawing area of a single window (see AbstractWindow), created by a Renderer.
+ *
+ * Positions are relative to the surface. What is drawn is only staged with stage(), it reaches the
+ * screen with the next Renderer::flush(). Drawing outside of the surface is clipped.
+ */
+class Surface
+{
+public:
+    Surface(Surface const &) = delete;
+    Surface & operator=(Surface const &) = delete;
+
+    Surface() = default;
+    virtual ~Surface() = default;
+
+    // characters beyond ascii, drawn with the terminal's line drawing characters
+    enum glyph
+    {
+        ULCORNER = 256,
+        URCORNER,
+        LLCORNER,
+        LRCORNER,
+        HLINE,
+        VLINE,
+        LTEE,
+        RTEE
+    };
+
+    // attributes of what is drawn next, combined with bitwise or
+    enum attribute
+    {
+        NORMAL = 0,
+        REVERSE = 1,
+        BOLD = 2
+    };
+
+    /**
+     * @param[in] y Row
+     * @param[in] x Column
+     * @param[in] ch A printable ascii character or a glyph
+     */
+    virtual void put(int y, int x, int ch) = 0;
+
+    /**
+     * @param[in] y Row
+     * @param[in] x Column of the first character
+     * @param[in] s Printable ascii characters
+     */
+    virtual void put_string(int y, int x, std::string_view s) = 0;
+
+    /**
+     * @param[in] y Row
+     * @param[in] x Column of the first character
+     * @param[in] ch A printable ascii character or a glyph
+     * @param[in] count Number of times to draw ch
+     */
+    virtual void fill(int y, int x, int ch, int count) = 0;
+
+    /**
+     * @param[in] y Row
+     * @param[in] x Column
+     * @returns The character or glyph drawn at the given position, ' ' outside of the surface
+     */
+    virtual int char_at(int y, int x) const = 0;
+
+    virtual void attribute_on(attribute a) = 0;
+    virtual void attribute_off(attribute a) = 0;
+
+    /**
+     * Blank the whole surface, and have the next flush redraw its area of the screen from scratch
+     */
+    virtual void clear() = 0;
+
+    /**
+     * Draw a line around the edges of the surface
+     */
+    virtual void draw_border() = 0;
+
+    /**
+     * Move the rows within [top..bottom] up (positive lines) or down (negative lines), blanking the rows
+     * scrolled into view. Backends may let the terminal do the scrolling
+     *
+     * @param[in] top First row to scroll
+     * @param[in] bottom Last row to scroll
+     * @param[in] lines Number of rows to scroll by
+     */
+    virtual void scroll_region(int top, int bottom, int lines) = 0;
+
+    /**
+     * Change size or position, keeping what is drawn where it still fits
+     *
+     * @returns false if it can not be done in place, in which case the surface must be recreated
+     */
+    virtual bool resize(int height, int width) = 0;
+    virtual bool move_to(int y, int x) = 0;
+
+    /**
+     * Have the next stage() copy the whole surface, not only what changed since the last stage()
+     */
+    virtual void touch() = 0;
+
+    /**
+     * Stage what was drawn for the next Renderer::flush()
+     */
+    virtual void stage() = 0;
+
+    /**
+     * @returns The ncurses WINDOW behind the surface for keyboard input, or nullptr if there is none
+     */
+    virtual WINDOW * input_window() const { return nullptr; }
+};
+
+
+/**
+ * Renderer creates the surfaces that windows draw on, and sends their staged content to the screen.
+ * The default renderer draws with ncurses, see CursesRenderer and GridRenderer.
+ *
+ * All calls must be made from the thread doing the drawing.
+ */
+class Renderer
+{
+public:
+    Renderer(Renderer const &) = delete;
+    Renderer & operator=(Renderer const &) = delete;
+
+    Renderer() = default;
+    virtual ~Renderer() = default;
+
+    /**
+     * @param[in] height Number of rows
+     * @param[in] width Number of columns
+     * @param[in] y Row of the top left corner on the screen
+     * @param[in] x Column of the top left corner on the screen
+     * @returns A new surface, or nullptr if it could not be created
+     */
+    virtual std::unique_ptr<Surface> create_surface(int height, int width, int y, int x) = 0;
+
+    /**
+     * Send everything staged since the last flush to the screen
+     */
+    virtual void flush() = 0;
+
+    /**
+     * @param[out] rows The screen's height
+     * @param[out] cols The screen's width
+     */
+    virtual void get_size(int & rows, int & cols) const = 0;
+
+    /**
+     * @returns The renderer all windows draw with
+     */
+    static Renderer & get();
+
+    /**
+     * Switch renderers. Must happen before any window is created
+     *
+     * @param[in] r The renderer to use from now on, or nullptr for the default ncurses renderer
+     */
+    static void set(Renderer * r);
+};
@@ -21,7 +21,10 @@ PROPERTYx1_MATCHABLE(
     CompletionList,
     Length_spc_Completion,
     Ordinal_spc_Summation,
-    Antonyms
+    Antonyms,
+    Shim_spc_Stats,
+    Frame_spc_Stats,
+    Memory_spc_Stats
 );
 
 using animation_content = std::array<std::vector<std::string>, 24> const *;
@@ -41,11 +44,46 @@ PROPERTYx1_MATCHABLE(
     Busy_spc_Animation
 )
 
+// 0 for as many threads as the hardware supports, see thread_pool::set_size()
+PROPERTYx1_MATCHABLE(
+    int, count,
+
+    ThreadCount,
+
+    esc_Hardware,
+    esc_1,
+    esc_2,
+    esc_4,
+    esc_8,
+    esc_16
+)
+PROPERTYx1_MATCHABLE(
+    ThreadCount::Type, thread_count,
+
+    ThreadCountSetting,
+
+    Worker_spc_Threads
+)
+
 
 MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Borders, enabledness, Enabledness::Enabled::grab());
 MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, CompletionList, enabledness, Enabledness::Enabled::grab());
 MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Length_spc_Completion, enabledness, Enabledness::Disabled::grab());
 MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Ordinal_spc_Summation, enabledness, Enabledness::Disabled::grab());
 MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Antonyms, enabledness, Enabledness::Disabled::grab());
+MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Shim_spc_Stats, enabledness, Enabledness::Disabled::grab());
+MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Frame_spc_Stats, enabledness, Enabledness::Disabled::grab());
+MATCHABLE_VARIANT_PROPERTY_VALUE(EnablednessSetting, Memory_spc_Stats, enabledness, Enabledness::Disabled::grab());
 
 MATCHABLE_VARIANT_PROPERTY_VALUE(AnimationSetting, Busy_spc_Animation, animation, Animation::esc_Default::grab());
+
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_Hardware, count, 0);
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_1, count, 1);
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_2, count, 2);
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_4, count, 4);
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_8, count, 8);
+MATCHABLE_VARIANT_PROPERTY_VALUE(ThreadCount, esc_16, count, 16);
+
+MATCHABLE_VARIANT_PROPERTY_VALUE(
+    ThreadCountSetting, Worker_spc_Threads, thread_count, ThreadCount::esc_Hardware::grab()
+);
@@ -23,6 +23,8 @@ static std::vector<std::string> const content =
         content.push_back("                      or arrow left/right when help shown");
         content.push_back("     change setting   Return");
         content.push_back("   change selection   arrow up/down");
+        content.push_back("  toggle shim stats   any F key (F1..F12)");
+        content.push_back("        reset stats   Del (while stats shown)");
         content.push_back("   enter shell mode   any of '$', '~', '`'");
         content.push_back("               quit   Esc, ctrl + c");
         content.push_back("");
@@ -31,10 +33,9 @@ static std::vector<std::string> const content =
 
 
 
-std::string SettingsHelpWindow::title()
+void SettingsHelpWindow::title(std::string & t)
 {
-    static std::string const t{"Help"};
-    return t;
+    t = "Help";
 }
 
 
@@ -68,17 +69,17 @@ void SettingsHelpWindow::draw_hook()
 
         int j = 0;
         for (; j < (int) line.size() && j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, line[j]);
+            w->put(i + 1, j + 1, line[j]);
 
         // blank out rest of line
         for (; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
     }
 
     // blank out remaining lines
     for (; i < height - 2; ++i)
         for (int j = 0; j < width - 2; ++j)
-            mvwaddch(w, i + 1, j + 1, ' ');
+            w->put(i + 1, j + 1, ' ');
 }
 
 
@@ -6,6 +6,12 @@
 #include "SettingsHelpWindow.h"
 #include "SettingsTab.h"
 #include "SettingsWindow.h"
+#include "Settings.h"
+#include "StatsWindow.h"
+#include "VisibilityAspect.h"
+#include "frame.h"
+#include "matchmaker.h"
+#include "thread_pool.h"
 
 
 SettingsTabAgent::SettingsTabAgent(
@@ -17,6 +23,7 @@ SettingsTabAgent::SettingsTabAgent(
     , access_help_win{std::make_shared<AccessHelpWindow>()}
     , help_win{std::make_shared<SettingsHelpWindow>()}
     , settings_win{std::make_shared<SettingsWindow>()}
+    , stats_win{std::make_shared<StatsWindow>()}
     , settings_tab{std::make_shared<SettingsTab>()}
 {
     settings_tab->add_window(tab_desc_win.get());
@@ -25,5 +32,40 @@ SettingsTabAgent::SettingsTabAgent(
     settings_tab->add_window(access_help_win.get());
     settings_tab->add_window(help_win.get());
     settings_tab->add_window(settings_win.get());
+    settings_tab->add_window(stats_win.get());
     settings_tab->set_active_window(settings_win.get());
+
+    // F layer starts hidden
+    stats_win->disable(VisibilityAspect::WindowVisibility::grab());
+
+    // shim instrumentation follows its setting
+    auto on_shim_stats_enabledness =
+        []()
+        {
+            matchmaker::set_stats_enabled(
+                EnablednessSetting::Shim_spc_Stats::grab().as_enabledness() == Enabledness::Enabled::grab()
+            );
+        };
+    on_shim_stats_enabledness();
+    EnablednessSetting::Shim_spc_Stats::grab().add_enabledness_observer(on_shim_stats_enabledness);
+
+    // as does the counting of bytes sent to the terminal per frame
+    auto on_frame_stats_enabledness =
+        []()
+        {
+            frame::set_stats_enabled(
+                EnablednessSetting::Frame_spc_Stats::grab().as_enabledness() == Enabledness::Enabled::grab()
+            );
+        };
+    on_frame_stats_enabledness();
+    EnablednessSetting::Frame_spc_Stats::grab().add_enabledness_observer(on_frame_stats_enabledness);
+
+    // background work shares one pool of worker threads
+    auto on_thread_count =
+        []()
+        {
+            thread_pool::set_size(ThreadCountSetting::Worker_spc_Threads::grab().as_thread_count().as_count());
+        };
+    on_thread_count();
+    ThreadCountSetting::Worker_spc_Threads::grab().add_thread_count_observer(on_thread_count);
 }
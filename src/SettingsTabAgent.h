@@ -12,6 +12,7 @@ class TabDescriptionWindow;
 class AccessHelpWindow;
 class SettingsHelpWindow;
 class SettingsWindow;
+class StatsWindow;
 
 /**
  * SettingsTabAgent constructs and provides access to SettingsTab
@@ -32,5 +33,6 @@ private:
     std::shared_ptr<AccessHelpWindow> access_help_win;
     std::shared_ptr<SettingsHelpWindow> help_win;
     std::shared_ptr<SettingsWindow> settings_win;
+    std::shared_ptr<StatsWindow> stats_win;
     std::shared_ptr<SettingsTab> settings_tab;
 };
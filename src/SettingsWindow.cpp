@@ -1,5 +1,6 @@
 #include "SettingsWindow.h"
 
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,19 +11,59 @@
 #include "Layer.h"
 #include "Settings.h"
 #include "VisibilityAspect.h"
+#include "matchmaker.h"
+#include "memory_accounting.h"
 
 
 
-std::string SettingsWindow::title()
+// bytes in the largest unit that keeps them short, for example 1.5M
+static std::string compact_bytes(uint64_t bytes)
 {
-    static std::string const t{"Settings"};
-    return t;
+    char buf[16];
+    if (bytes < 1024 * 1024)
+        snprintf(buf, sizeof(buf), "%lluK", (unsigned long long) ((bytes + 1023) / 1024));
+    else if (bytes < 1024 * 1024 * 1024)
+        snprintf(buf, sizeof(buf), "%.1fM", bytes / (1024.0 * 1024));
+    else
+        snprintf(buf, sizeof(buf), "%.1fG", bytes / (1024.0 * 1024 * 1024));
+
+    return buf;
+}
+
+
+// one line of what the completable tab and the library hold, see the shell's :mem for everything
+static std::string memory_line()
+{
+    memory_accounting::component_stats stack;
+    memory_accounting::component_stats caches;
+    memory_accounting::component_stats words;
+    memory_accounting::collect_stats(memory_accounting::COMPLETION_STACK, &stack);
+    memory_accounting::collect_stats(memory_accounting::WORD_CACHES, &caches);
+    memory_accounting::collect_stats(memory_accounting::WORD_STACK, &words);
+
+    memory_accounting::mapping_stats library;
+    memory_accounting::collect_file_mappings(matchmaker::library_address(), &library);
+
+    return "stack " + compact_bytes(stack.bytes)
+           + "  caches " + compact_bytes(caches.bytes)
+           + "  words " + compact_bytes(words.bytes)
+           + "  lib rss " + compact_bytes(library.rss);
+}
+
+
+void SettingsWindow::title(std::string & t)
+{
+    t = "Settings";
 }
 
 
 void SettingsWindow::resize_hook()
 {
-    height = EnablednessSetting::variants().size() + 4;
+    // 2 for borders, 1 for space above settings, 2 for the memory line and the space above it
+    height = EnablednessSetting::variants().size()
+             + AnimationSetting::variants().size()
+             + ThreadCountSetting::variants().size()
+             + 5;
     width = 53;
 
     // center window
@@ -43,6 +84,9 @@ void SettingsWindow::draw_hook()
             for (auto s : AnimationSetting::variants())
                 if (max_len < (int) s.as_string().length())
                     max_len = s.as_string().length();
+            for (auto s : ThreadCountSetting::variants())
+                if (max_len < (int) s.as_string().length())
+                    max_len = s.as_string().length();
             return max_len + 7;
         }();
 
@@ -50,25 +94,22 @@ void SettingsWindow::draw_hook()
     for (auto setting : EnablednessSetting::variants())
     {
         // print setting name
-        mvwprintw(
-            w,
+        w->put_string(
             setting.as_index() + 2,
             right_align - setting.as_string().length(),
-            "%s", setting.as_string().c_str()
+            setting.as_string()
         );
 
-        mvwprintw(w, setting.as_index() + 2, right_align, ":");
+        w->put_string(setting.as_index() + 2, right_align, ":");
 
         // print enabledness
         if (setting.as_index() == selection)
-            wattron(w, A_REVERSE);
-        mvwprintw(w, setting.as_index() + 2, right_align + 2,
-                  "%s", setting.as_enabledness().as_string().c_str());
-        wattroff(w, A_REVERSE);
+            w->attribute_on(Surface::REVERSE);
+        w->put_string(setting.as_index() + 2, right_align + 2, setting.as_enabledness().as_string());
+        w->attribute_off(Surface::REVERSE);
 
         // clear space after "Enabled" since "Disabled" is a char longer
-        mvwaddch(
-            w,
+        w->put(
             setting.as_index() + 2,
             right_align + 2 + setting.as_enabledness().as_string().size(),
             ' '
@@ -78,34 +119,60 @@ void SettingsWindow::draw_hook()
     for (auto setting : AnimationSetting::variants())
     {
         // print setting name
-        mvwprintw(
-            w,
+        w->put_string(
             EnablednessSetting::variants().size() + setting.as_index() + 2,
             right_align - setting.as_string().length(),
-            "%s", setting.as_string().c_str()
+            setting.as_string()
         );
 
-        mvwprintw(w, EnablednessSetting::variants().size() + setting.as_index() + 2, right_align, ":");
+        w->put_string(EnablednessSetting::variants().size() + setting.as_index() + 2, right_align, ":");
 
         // print enabledness
         if (setting.as_index() + (int) EnablednessSetting::variants().size() == selection)
-            wattron(w, A_REVERSE);
-        mvwprintw(
-            w,
+            w->attribute_on(Surface::REVERSE);
+        w->put_string(
             EnablednessSetting::variants().size() + setting.as_index() + 2,
             right_align + 2,
-            "%s", setting.as_animation().as_string().c_str()
+            setting.as_animation().as_string()
         );
-        wattroff(w, A_REVERSE);
+        w->attribute_off(Surface::REVERSE);
 
         // clear space after "Enabled" since "Disabled" is a char longer
-        mvwprintw(
-            w,
+        w->put_string(
             EnablednessSetting::variants().size() + setting.as_index() + 2,
             right_align + 2 + setting.as_animation().as_string().size(),
             "      "
         );
     }
+
+    int const thread_rows_start = EnablednessSetting::variants().size() + AnimationSetting::variants().size();
+    for (auto setting : ThreadCountSetting::variants())
+    {
+        int const row = thread_rows_start + setting.as_index() + 2;
+
+        // print setting name
+        w->put_string(row, right_align - setting.as_string().length(), setting.as_string());
+
+        w->put_string(row, right_align, ":");
+
+        // print thread count
+        if (setting.as_index() + thread_rows_start == selection)
+            w->attribute_on(Surface::REVERSE);
+        w->put_string(row, right_align + 2, setting.as_thread_count().as_string());
+        w->attribute_off(Surface::REVERSE);
+
+        // clear space after shorter counts
+        w->put_string(row, right_align + 2 + setting.as_thread_count().as_string().size(), "        ");
+    }
+
+    // memory line, blanked out while disabled
+    {
+        std::string line;
+        if (EnablednessSetting::Memory_spc_Stats::grab().as_enabledness() == Enabledness::Enabled::grab())
+            line = memory_line();
+        line.resize(width - 4, ' ');
+        w->put_string(height - 2, 2, line);
+    }
 }
 
 
@@ -139,6 +206,21 @@ void SettingsWindow::on_RETURN()
         setting.set_animation(Animation::from_index(index));
         mark_dirty();
     }
+    else if (selection < (int) (EnablednessSetting::variants().size()
+                                + AnimationSetting::variants().size()
+                                + ThreadCountSetting::variants().size()))
+    {
+        auto setting = ThreadCountSetting::from_index(
+            selection - EnablednessSetting::variants().size() - AnimationSetting::variants().size()
+        );
+
+        int index = setting.as_thread_count().as_index() + 1;
+        if (index >= (int) ThreadCount::variants().size())
+            index = 0;
+
+        setting.set_thread_count(ThreadCount::from_index(index));
+        mark_dirty();
+    }
 }
 
 
@@ -154,7 +236,10 @@ void SettingsWindow::on_KEY_UP()
 
 void SettingsWindow::on_KEY_DOWN()
 {
-    if (selection < (int) (EnablednessSetting::variants().size() + AnimationSetting::variants().size() - 1))
+    int const setting_count = EnablednessSetting::variants().size()
+                              + AnimationSetting::variants().size()
+                              + ThreadCountSetting::variants().size();
+    if (selection < setting_count - 1)
     {
         ++selection;
         mark_dirty();
@@ -0,0 +1,199 @@
+#include "StatsWindow.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <ncurses.h>
+
+#include "AbstractListWindow.h"
+#include "Layer.h"
+#include "exec_long_task_with_busy_animation.h"
+#include "frame.h"
+#include "matchmaker.h"
+#include "thread_pool.h"
+
+
+
+// print a single line within the window's borders, blanking out the rest of the line
+static void print_line(Surface * w, int line, int width, char const * str)
+{
+    int j = 0;
+    for (; str[j] != '\0' && j < width - 2; ++j)
+        w->put(line, j + 1, str[j]);
+
+    for (; j < width - 2; ++j)
+        w->put(line, j + 1, ' ');
+}
+
+
+void StatsWindow::title(std::string & t)
+{
+    t = "Stats";
+}
+
+
+void StatsWindow::resize_hook()
+{
+    height = (int) (root_y / 1.618 + 0.5);
+    width = 76;
+    y = (root_y - height) / 2;
+    x = (root_x - width) / 2;
+}
+
+
+void StatsWindow::draw_hook()
+{
+    std::vector<matchmaker::function_stats> stats;
+    for (int i = 0; i < matchmaker::stats_count(); ++i)
+    {
+        matchmaker::function_stats fs;
+        matchmaker::collect_stats(i, &fs);
+        if (fs.calls > 0)
+            stats.push_back(fs);
+    }
+
+    // most expensive first
+    std::sort(
+        stats.begin(),
+        stats.end(),
+        [](auto const & a, auto const & b) { return a.total_ns > b.total_ns; }
+    );
+
+    if (display_start >= (int) stats.size())
+        display_start = (int) stats.size() - 1;
+    if (display_start < 0)
+        display_start = 0;
+
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%-22s%12s%10s%10s%10s%10s", "function", "calls", "mean ns", "p50 ns",
+             "p99 ns", "p999 ns");
+    print_line(w.get(), 1, width, buf);
+
+    // 2 for borders, 1 for header, 6 for footer
+    int line = 2;
+    for (int i = display_start; i < (int) stats.size() && line < height - 7; ++i, ++line)
+    {
+        auto const & fs = stats[i];
+        snprintf(
+            buf, sizeof(buf), "%-22s%12llu%10llu%10llu%10llu%10llu",
+            fs.name,
+            (unsigned long long) fs.calls,
+            (unsigned long long) (fs.total_ns / fs.calls),
+            (unsigned long long) matchmaker::stats_percentile(fs, 0.5),
+            (unsigned long long) matchmaker::stats_percentile(fs, 0.99),
+            (unsigned long long) matchmaker::stats_percentile(fs, 0.999)
+        );
+        print_line(w.get(), line, width, buf);
+    }
+
+    // blank out remaining lines
+    for (; line < height - 7; ++line)
+        print_line(w.get(), line, width, "");
+
+    {
+        thread_pool::lane_stats interactive;
+        thread_pool::lane_stats idle;
+        thread_pool::collect_stats(thread_pool::INTERACTIVE, &interactive);
+        thread_pool::collect_stats(thread_pool::IDLE, &idle);
+        snprintf(buf, sizeof(buf), "pool %d  interactive q %llu/%llu done %llu stolen %llu  idle q %llu/%llu done %llu",
+                 thread_pool::size(),
+                 (unsigned long long) interactive.depth,
+                 (unsigned long long) interactive.max_depth,
+                 (unsigned long long) interactive.completed,
+                 (unsigned long long) interactive.stolen,
+                 (unsigned long long) idle.depth,
+                 (unsigned long long) idle.max_depth,
+                 (unsigned long long) idle.completed);
+        print_line(w.get(), height - 7, width, buf);
+    }
+
+    if (recent_tasks().empty())
+    {
+        snprintf(buf, sizeof(buf), "no long task run yet");
+    }
+    else
+    {
+        auto const & t = recent_tasks().back();
+        snprintf(buf, sizeof(buf), "last task: %s%s  items: %llu  ms: %llu  items/s: %llu",
+                 t.name.c_str(),
+                 t.completed ? "" : " (cancelled)",
+                 (unsigned long long) t.items,
+                 (unsigned long long) t.elapsed_ms,
+                 (unsigned long long) (t.elapsed_ms == 0 ? 0 : t.items * 1000 / t.elapsed_ms));
+    }
+    print_line(w.get(), height - 6, width, buf);
+
+    std::string drawn{"last frame drew: "};
+    for (auto const & [window, reason] : frame::last_frame_draws())
+        drawn += window + " (" + reason + ")  ";
+    print_line(w.get(), height - 5, width, drawn.c_str());
+
+    frame::frame_stats frs;
+    frame::collect_stats(&frs);
+
+    AbstractListWindow::cache_stats cs;
+    AbstractListWindow::collect_cache_stats(&cs);
+    snprintf(buf, sizeof(buf), "word caches  hits: %llu  misses: %llu    windows drawn: %llu  skipped: %llu",
+             (unsigned long long) cs.hits,
+             (unsigned long long) cs.misses,
+             (unsigned long long) frs.windows_drawn,
+             (unsigned long long) frs.draws_skipped);
+    print_line(w.get(), height - 4, width, buf);
+
+    if (frame::stats_enabled())
+        snprintf(buf, sizeof(buf), "frames: %llu    bytes/frame  last: %llu  mean: %llu  max: %llu",
+                 (unsigned long long) frs.frames,
+                 (unsigned long long) frs.last_bytes,
+                 (unsigned long long) (frs.frames == 0 ? 0 : frs.bytes / frs.frames),
+                 (unsigned long long) frs.max_bytes);
+    else
+        snprintf(buf, sizeof(buf), "frame stats disabled (see settings)");
+    print_line(w.get(), height - 3, width, buf);
+
+    snprintf(buf, sizeof(buf), "shim stats %s    Return: refresh    Del: reset",
+             matchmaker::stats_enabled() ? "enabled" : "disabled (see settings)");
+    print_line(w.get(), height - 2, width, buf);
+}
+
+
+Layer::Type StatsWindow::layer() const
+{
+    return Layer::F::grab();
+}
+
+
+void StatsWindow::on_KEY_UP()
+{
+    if (display_start > 0)
+    {
+        --display_start;
+        mark_dirty();
+    }
+}
+
+
+void StatsWindow::on_KEY_DOWN()
+{
+    // upper bound is clamped within draw_hook() once the number of called functions is known
+    ++display_start;
+    mark_dirty();
+}
+
+
+void StatsWindow::on_RETURN()
+{
+    mark_dirty();
+}
+
+
+void StatsWindow::on_DELETE()
+{
+    matchmaker::reset_stats();
+    frame::reset_stats();
+    AbstractListWindow::reset_cache_stats();
+    thread_pool::reset_stats();
+    display_start = 0;
+    mark_dirty();
+}
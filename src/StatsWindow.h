@@ -0,0 +1,29 @@
+#pragma once
+
+#include "AbstractWindow.h"
+
+
+
+/**
+ * StatsWindow shows call counts and latencies recorded by the matchmaker shim's instrumentation
+ * (see matchmaker::set_stats_enabled()) along with the bytes sent to the terminal per frame
+ * (see frame::set_stats_enabled())
+ */
+class StatsWindow : public AbstractWindow
+{
+    using AbstractWindow::AbstractWindow;
+
+    // resolved dependencies
+    void title(std::string &) final;
+    void resize_hook() final;
+    void draw_hook() final;
+    Layer::Type layer() const final;
+
+    // options
+    void on_KEY_UP() final;
+    void on_KEY_DOWN() final;
+    void on_RETURN() final;
+    void on_DELETE() final;
+
+    int display_start{0};
+};
@@ -25,16 +25,11 @@ SynonymWindow::SynonymWindow(
 }
 
 
-std::string SynonymWindow::title()
+void SynonymWindow::title(std::string & t)
 {
-    std::string t{"Synonyms ("};
-
-    auto syn = get_words();
-    t += std::to_string(syn.size());
-
+    t = "Synonyms (";
+    t += std::to_string(get_words().size());
     t += ")";
-
-    return t;
 }
 
 
@@ -16,7 +16,7 @@ public:
 
 private:
     // resolved AbstractWindow dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
 
     // resolved AbstractListWindow dependencies
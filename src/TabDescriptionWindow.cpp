@@ -7,10 +7,9 @@
 
 
 
-std::string TabDescriptionWindow::title()
+void TabDescriptionWindow::title(std::string & t)
 {
-    static std::string const t;
-    return t;
+    t.clear();
 }
 
 
@@ -30,7 +29,7 @@ void TabDescriptionWindow::draw_hook()
         return;
 
     for (int i = 0; i < (int) tab.as_string().length() && i < width; ++i)
-        mvwaddch(w, 1, i, tab.as_string()[i]);
+        w->put(1, i, tab.as_string()[i]);
 }
 
 
@@ -40,7 +39,8 @@ void TabDescriptionWindow::post_resize_hook()
     // As such, it has been recruited to be the window used for the keypad.
     // All key events regardless of what tab or window is active come through
     // TabDescriptionWindow's low level ncurses WINDOW.
-    keypad(w, true);
+    if (nullptr != get_WINDOW())
+        keypad(get_WINDOW(), true);
 }
 
 
@@ -12,7 +12,7 @@ class TabDescriptionWindow : public AbstractWindow
     using AbstractWindow::AbstractWindow;
 
     // resolved AbstractWindow dependencies
-    std::string title() final;
+    void title(std::string &) final;
     void resize_hook() final;
     void draw_hook() final;
     Layer::Type layer() const final;
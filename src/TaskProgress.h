@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+
+
+/**
+ * TaskProgress is shared between a long task, which reports how far it got and checks whether it should
+ * stop, and the main thread, which draws the progress and requests cancellation (see exec_long_task()).
+ *
+ * All members are safe to call from any thread.
+ */
+class TaskProgress
+{
+public:
+    TaskProgress(TaskProgress const &) = delete;
+    TaskProgress & operator=(TaskProgress const &) = delete;
+
+    TaskProgress() = default;
+
+    /**
+     * @param[in] total Number of items the task is going to process, 0 if unknown
+     */
+    void set_total(uint64_t total) { total_items.store(total, std::memory_order_relaxed); }
+    uint64_t get_total() const { return total_items.load(std::memory_order_relaxed); }
+
+    /**
+     * Report processed items. Tasks processing many small items should report them in chunks
+     *
+     * @param[in] count Number of items processed since the last call
+     */
+    void advance(uint64_t count = 1) { done_items.fetch_add(count, std::memory_order_relaxed); }
+    uint64_t get_done() const { return done_items.load(std::memory_order_relaxed); }
+
+    /**
+     * Ask the task to stop early
+     */
+    void cancel() { cancel_requested.store(true, std::memory_order_relaxed); }
+
+    /**
+     * Tasks check this between chunks of work and stop early when it turns true
+     *
+     * @returns true if cancellation was requested, false otherwise
+     */
+    bool cancelled() const { return cancel_requested.load(std::memory_order_relaxed); }
+
+
+private:
+    std::atomic<uint64_t> total_items{0};
+    std::atomic<uint64_t> done_items{0};
+    std::atomic<bool> cancel_requested{false};
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "memory_accounting.h"
+#include "word_stack_element.h"
+
+
+
+/**
+ * WordStack keeps the words left behind by selecting a listed word (see AbstractListWindow::on_RETURN()),
+ * so that DELETE can return to them. The bytes it holds are accounted as memory_accounting::WORD_STACK
+ */
+class WordStack
+{
+public:
+    WordStack(WordStack const &) = delete;
+    WordStack & operator=(WordStack const &) = delete;
+
+    WordStack() = default;
+
+    void push(word_stack_element const & e)
+    {
+        elements.push_back(e);
+        account_memory();
+    }
+
+    void pop()
+    {
+        elements.pop_back();
+        account_memory();
+    }
+
+    word_stack_element const & top() const { return elements.back(); }
+    int size() const { return (int) elements.size(); }
+    bool empty() const { return elements.empty(); }
+
+private:
+    void account_memory()
+    {
+        uint64_t bytes{memory_accounting::heap_bytes(elements)};
+        for (auto const & e : elements)
+            bytes += memory_accounting::heap_bytes(e.word);
+
+        memory.set(bytes);
+    }
+
+    std::vector<word_stack_element> elements;
+    memory_accounting::account memory{memory_accounting::WORD_STACK};
+};
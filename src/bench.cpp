@@ -0,0 +1,199 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+#include "matchmaker.h"
+#include "word_filter.h"
+
+
+
+namespace bench
+{
+    using clock = std::chrono::steady_clock;
+
+    // number of back to back clock reads used to estimate what one clock read costs
+    static int const CLOCK_CALIBRATION_COUNT{1001};
+
+    // prefixes used by the completion workloads are at most this long
+    static int const MAX_PREFIX_LENGTH{3};
+
+    // defeats dead code elimination of results that are otherwise unused
+    static volatile int sink;
+
+
+    // median duration of a pair of clock reads without anything between them
+    static uint64_t clock_overhead_ns()
+    {
+        std::vector<uint64_t> samples(CLOCK_CALIBRATION_COUNT);
+        for (auto & s : samples)
+        {
+            auto const start = clock::now();
+            auto const stop = clock::now();
+            s = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+        }
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+
+        return samples[samples.size() / 2];
+    }
+
+
+    static uint64_t percentile(std::vector<uint64_t> & sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        size_t i = (size_t) (p * sorted.size());
+        if (i >= sorted.size())
+            i = sorted.size() - 1;
+
+        return sorted[i];
+    }
+
+
+    result measure(std::string const & workload, int warm_up, int iterations, std::function<void (int)> op)
+    {
+        return measure(workload, warm_up, iterations, [](int) {}, op);
+    }
+
+
+    result measure(std::string const & workload, int warm_up, int iterations,
+                   std::function<void (int)> prepare, std::function<void (int)> op)
+    {
+        for (int i = 0; i < warm_up; ++i)
+        {
+            prepare(i);
+            op(i);
+        }
+
+        uint64_t const overhead = clock_overhead_ns();
+
+        std::vector<uint64_t> timings(std::max(0, iterations));
+        uint64_t total{0};
+        for (int i = 0; i < iterations; ++i)
+        {
+            prepare(i);
+
+            auto const start = clock::now();
+            op(i);
+            auto const stop = clock::now();
+
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+            ns = ns > overhead ? ns - overhead : 0;
+            timings[i] = ns;
+            total += ns;
+        }
+
+        std::sort(timings.begin(), timings.end());
+
+        result r;
+        r.workload = workload;
+        r.ops = timings.size();
+        r.ns_per_op = r.ops == 0 ? 0.0 : (double) total / r.ops;
+        r.p50_ns = percentile(timings, 0.5);
+        r.p99_ns = percentile(timings, 0.99);
+        r.p999_ns = percentile(timings, 0.999);
+        r.ops_per_s = r.ns_per_op > 0.0 ? 1e9 / r.ns_per_op : 0.0;
+
+        return r;
+    }
+
+
+    std::vector<result> run_dictionary_workloads(std::vector<int> const & sample, int iterations)
+    {
+        std::vector<result> results;
+        if (sample.empty())
+            return results;
+
+        int const warm_up = iterations / 10;
+
+        // words and their prefixes are prepared up front so that only the library calls are timed
+        std::vector<std::string> words;
+        std::vector<std::string> prefixes;
+        for (int index : sample)
+        {
+            int length{0};
+            char const * w = matchmaker::at(index, &length);
+            words.emplace_back(w, length);
+            prefixes.emplace_back(w, std::min(length, MAX_PREFIX_LENGTH));
+        }
+        int const n = (int) sample.size();
+
+        results.push_back(measure("lookup", warm_up, iterations,
+            [&](int i)
+            {
+                bool found{false};
+                sink = matchmaker::lookup(words[i % n].c_str(), &found);
+            }
+        ));
+
+        results.push_back(measure("complete", warm_up, iterations,
+            [&](int i)
+            {
+                int start{0};
+                int length{0};
+                matchmaker::complete(prefixes[i % n].c_str(), &start, &length);
+                sink = start + length;
+            }
+        ));
+
+        results.push_back(measure("synonyms", warm_up, iterations,
+            [&](int i)
+            {
+                int const * syn{nullptr};
+                int count{0};
+                matchmaker::synonyms(sample[i % n], &syn, &count);
+                sink = count;
+            }
+        ));
+
+        results.push_back(measure("at", warm_up, iterations,
+            [&](int i)
+            {
+                int length{0};
+                sink = *matchmaker::at(sample[i % n], &length) + length;
+            }
+        ));
+
+        // hide names and places, as is commonly done in the filter window
+        word_filter wf;
+        wf.direction = filter_direction::exclusive::grab();
+        wf.logic = filter_logic::or_logic::grab();
+        wf.attributes.set(word_attribute::name::grab());
+        wf.attributes.set(word_attribute::place::grab());
+
+        results.push_back(measure("filtered complete", warm_up, iterations,
+            [&](int i)
+            {
+                int start{0};
+                int length{0};
+                matchmaker::complete(prefixes[i % n].c_str(), &start, &length);
+
+                int passed{0};
+                for (int w = start; w < start + length; ++w)
+                    if (wf.passes(w))
+                        ++passed;
+                sink = passed;
+            }
+        ));
+
+        return results;
+    }
+
+
+    std::vector<int> random_sample(int count, uint32_t seed)
+    {
+        std::vector<int> sample;
+        int const word_count = matchmaker::count();
+        if (word_count <= 0)
+            return sample;
+
+        std::mt19937 rng{seed};
+        std::uniform_int_distribution<int> pick{0, word_count - 1};
+        for (int i = 0; i < count; ++i)
+            sample.push_back(pick(rng));
+
+        return sample;
+    }
+}
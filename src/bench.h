@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+/*
+    Micro-benchmarks of the matchmaker hot paths. Single operations take well below a microsecond, so
+    every operation is timed on its own with a steady clock whose own cost is measured up front and
+    subtracted, and results are summarized as percentiles over many iterations.
+*/
+
+namespace bench
+{
+    struct result
+    {
+        std::string workload;
+        uint64_t ops;
+        double ns_per_op;   // mean
+        uint64_t p50_ns;
+        uint64_t p99_ns;
+        uint64_t p999_ns;
+        double ops_per_s;   // 1e9 / mean, from timed operations only
+    };
+
+    /**
+     * Time an operation
+     *
+     * @param[in] workload Name for the result
+     * @param[in] warm_up Number of untimed calls made first to fill caches
+     * @param[in] iterations Number of timed calls
+     * @param[in] op Called with the iteration number, starting at 0 for the warm-up and again for timing
+     * @returns The summarized timings
+     */
+    result measure(std::string const & workload, int warm_up, int iterations, std::function<void (int)> op);
+
+    /**
+     * Time an operation that needs preparation which should not be timed
+     *
+     * @param[in] workload Name for the result
+     * @param[in] warm_up Number of untimed calls made first to fill caches
+     * @param[in] iterations Number of timed calls
+     * @param[in] prepare Called untimed with the iteration number right before every call of op
+     * @param[in] op Called with the iteration number, starting at 0 for the warm-up and again for timing
+     * @returns The summarized timings
+     */
+    result measure(std::string const & workload, int warm_up, int iterations,
+                   std::function<void (int)> prepare, std::function<void (int)> op);
+
+    /**
+     * Run the lookup, complete, synonyms, at and filtered completion workloads over a sample of words
+     *
+     * @param[in] sample Indexes of the words to use, cycled through as needed
+     * @param[in] iterations Number of timed calls per workload, warm-up is a tenth of that
+     * @returns One result per workload
+     */
+    std::vector<result> run_dictionary_workloads(std::vector<int> const & sample, int iterations);
+
+    /**
+     * @param[in] count Number of words to pick
+     * @param[in] seed Seed for reproducible samples
+     * @returns Indexes of words picked at random from the loaded dictionary
+     */
+    std::vector<int> random_sample(int count, uint32_t seed);
+}
@@ -0,0 +1,189 @@
+#include "book_render.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "matchmaker.h"
+#include "thread_pool.h"
+
+
+
+namespace book_render
+{
+    static char const * const CHAPTER_RULE =
+        "***********************************************************************\n";
+    static char const * const TITLE_RULE =
+        "-----------------------------------------------------------------------\n";
+
+    // chapter buffers in flight per pool thread, one being rendered and one waiting to be written
+    static int const BUFFERS_PER_THREAD{2};
+
+
+    static void append_terms(int const * terms, int count, std::string & out)
+    {
+        for (int t = 0; t < count; ++t)
+        {
+            int length{0};
+            char const * term = matchmaker::at(terms[t], &length);
+            out.append(term, length);
+        }
+    }
+
+
+    static bool write_all(int fd, std::string const & text)
+    {
+        char const * data = text.data();
+        size_t remaining = text.size();
+        while (remaining > 0)
+        {
+            ssize_t const written = ::write(fd, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                return false;
+            }
+            data += written;
+            remaining -= written;
+        }
+
+        return true;
+    }
+
+
+    void render_header(int book_index, std::string & out)
+    {
+        out += "\n               title: ";
+        int const * title{nullptr};
+        int title_count{0};
+        matchmaker::book_title(book_index, &title, &title_count);
+        append_terms(title, title_count, out);
+
+        out += "\n              author: ";
+        int const * author{nullptr};
+        int author_count{0};
+        matchmaker::book_author(book_index, &author, &author_count);
+        append_terms(author, author_count, out);
+
+        out += "\n            chapters: ";
+        out += std::to_string(matchmaker::chapter_count(book_index));
+        out += "\n\n";
+    }
+
+
+    void render_paragraph(int book_index, int chapter_index, int paragraph_index, std::string & out,
+                          std::vector<int> * word_offsets)
+    {
+        int const word_count = matchmaker::word_count(book_index, chapter_index, paragraph_index);
+        for (int w = 0; w < word_count; ++w)
+        {
+            int ancestor_count{0};
+            int const * ancestors{nullptr};
+            int index_within_first_ancestor{-1};
+            int const term = matchmaker::word(book_index, chapter_index, paragraph_index, w, &ancestors,
+                                              &ancestor_count, &index_within_first_ancestor, nullptr);
+
+            int length{0};
+            char const * text = matchmaker::at(term, &length);
+            out += ' ';
+            if (nullptr != word_offsets)
+                word_offsets->push_back((int) out.size());
+            out.append(text, length);
+        }
+    }
+
+
+    void render_chapter(int book_index, int chapter_index, std::string & out)
+    {
+        out += "\n";
+        out += CHAPTER_RULE;
+        out += "   chapter title: ";
+        int const * title{nullptr};
+        int title_count{0};
+        matchmaker::chapter_title(book_index, chapter_index, &title, &title_count);
+        append_terms(title, title_count, out);
+
+        out += "\nchapter subtitle: ";
+        int const * subtitle{nullptr};
+        int subtitle_count{0};
+        matchmaker::chapter_subtitle(book_index, chapter_index, &subtitle, &subtitle_count);
+        append_terms(subtitle, subtitle_count, out);
+        out += "\n";
+        out += TITLE_RULE;
+
+        int const paragraph_count = matchmaker::paragraph_count(book_index, chapter_index);
+        for (int p = 0; p < paragraph_count; ++p)
+        {
+            render_paragraph(book_index, chapter_index, p, out, nullptr);
+            out += '\n';
+        }
+
+        out += CHAPTER_RULE;
+        out += "\n\n\n";
+    }
+
+
+    bool write_book(int book_index, int fd)
+    {
+        std::string header;
+        render_header(book_index, header);
+        if (!write_all(fd, header))
+            return false;
+
+        int const chapter_count = matchmaker::chapter_count(book_index);
+        int threads = thread_pool::size();
+        if (threads == 0) // not started yet, it will start with the hardware's concurrency
+            threads = std::max(1, (int) std::thread::hardware_concurrency());
+        int const slot_count = std::min(chapter_count, threads * BUFFERS_PER_THREAD);
+
+        // chapter c is rendered into buffers[c % slot_count], which is reused once chapter c is written
+        std::vector<std::string> buffers(slot_count);
+        std::vector<std::future<void>> rendered(slot_count);
+
+        auto render = [&](int chapter)
+        {
+            std::string & buffer = buffers[chapter % slot_count];
+            rendered[chapter % slot_count] = thread_pool::submit(
+                thread_pool::INTERACTIVE,
+                [book_index, chapter, &buffer]()
+                {
+                    auto library_lock = matchmaker::lock_library();
+                    render_chapter(book_index, chapter, buffer);
+                }
+            );
+        };
+
+        for (int c = 0; c < slot_count; ++c)
+            render(c);
+
+        for (int c = 0; c < chapter_count; ++c)
+        {
+            int const slot = c % slot_count;
+            thread_pool::get(rendered[slot]);
+
+            if (!write_all(fd, buffers[slot]))
+            {
+                // chapters still being rendered reference the buffers
+                int const error = errno;
+                for (auto & r : rendered)
+                    if (r.valid())
+                        thread_pool::get(r);
+                errno = error;
+
+                return false;
+            }
+            buffers[slot].clear();
+
+            if (c + slot_count < chapter_count)
+                render(c + slot_count);
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+/*
+    Renders books as text the way the shell's :book command shows them. Text is assembled in large
+    buffers and written with one write() per chapter instead of going through iostreams word by word, so
+    that exporting a book is bound by the output rather than by formatting.
+*/
+
+namespace book_render
+{
+    /**
+     * Append a book's title, author and chapter count
+     *
+     * @param[in] book_index The book to render
+     * @param[out] out Text is appended here
+     */
+    void render_header(int book_index, std::string & out);
+
+    /**
+     * Append a paragraph's words, each preceded by a space. Safe to call from any thread holding a
+     * library lock (see matchmaker::lock_library())
+     *
+     * @param[in] book_index The book containing the paragraph
+     * @param[in] chapter_index The chapter containing the paragraph
+     * @param[in] paragraph_index The paragraph to render
+     * @param[out] out Text is appended here
+     * @param[out] word_offsets If not nullptr, receives the offset within out of every word rendered
+     */
+    void render_paragraph(int book_index, int chapter_index, int paragraph_index, std::string & out,
+                          std::vector<int> * word_offsets);
+
+    /**
+     * Append a chapter's title, subtitle and paragraphs. Safe to call from any thread holding a library
+     * lock (see matchmaker::lock_library())
+     *
+     * @param[in] book_index The book containing the chapter
+     * @param[in] chapter_index The chapter to render
+     * @param[out] out Text is appended here
+     */
+    void render_chapter(int book_index, int chapter_index, std::string & out);
+
+    /**
+     * Render a whole book and write it to a file descriptor. Chapters are rendered in parallel on the
+     * thread pool and written in order, with a bounded number of chapter buffers that are reused
+     *
+     * @param[in] book_index The book to render
+     * @param[in] fd Where to write, callers writing to stdout must flush std::cout first
+     * @returns true on success, false if writing failed (errno tells why)
+     */
+    bool write_book(int book_index, int fd);
+}
@@ -1,31 +1,488 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <iostream>
 
 #include <ncurses.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 #include "CompletableTabAgent.h"
+#include "GridRenderer.h"
 #include "Settings.h"
 #include "IndicatorWindow.h"
 #include "MatchmakerTab.h"
 #include "MatchmakerTabAgent.h"
 #include "TabDescriptionWindow.h"
 #include "SettingsTabAgent.h"
+#include "event_loop.h"
 #include "key_codes.h"
+#include "keystroke_log.h"
+#include "latency_report.h"
 #include "matchmaker.h"
 #include "completable_shell.h"
 
 
 
+namespace
+{
+    // upper bound on keys handled between two draws
+    int const KEY_BATCH_CAPACITY{256};
+
+    // resizes arrive in bursts while a terminal edge is dragged, so wait for the size to settle
+    std::chrono::milliseconds const RESIZE_SETTLE{40};
+
+    /**
+     * Take whatever keys are queued without waiting (see event_loop::wait())
+     *
+     * @param[in] win The window used for keyboard input
+     * @param[out] keys Storage for the keys read
+     * @param[in] capacity Maximum number of keys to read
+     * @returns The number of keys read
+     */
+    int read_keys(WINDOW * win, int * keys, int capacity)
+    {
+        int count{0};
+
+        nodelay(win, true);
+        while (count < capacity)
+        {
+            int const ch = wgetch(win);
+            if (ch == ERR)
+                break;
+            keys[count++] = ch;
+        }
+        nodelay(win, false);
+
+        return count;
+    }
+
+    // bring ncurses up to date with the terminal's current size
+    void update_terminal_size()
+    {
+        winsize ws;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0)
+            resizeterm(ws.ws_row, ws.ws_col);
+    }
+
+    /**
+     * Run the shell without ncurses on a script, see completable_shell_batch()
+     *
+     * @param[in] argc Number of arguments following --batch
+     * @param[in] argv Arguments following --batch: [--library <libmatchmaker.so>] [script]
+     * @returns The process exit status
+     */
+    int run_batch(int argc, char ** argv)
+    {
+        char const * library{nullptr};
+        char const * script{nullptr};
+        for (int i = 0; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--library") == 0 && i + 1 < argc)
+                library = argv[++i];
+            else
+                script = argv[i];
+        }
+
+        // output goes to pipes and files, so buffer it fully and never sync with stdio
+        static char out_buffer[64 * 1024];
+        std::ios::sync_with_stdio(false);
+        std::cin.tie(nullptr);
+        std::cout.rdbuf()->pubsetbuf(out_buffer, sizeof(out_buffer));
+
+#ifdef MM_DYNAMIC_LOADING
+        if (nullptr == library)
+        {
+            std::cerr << "--batch needs --library <libmatchmaker.so> when built for dynamic loading\n";
+            return EXIT_FAILURE;
+        }
+        if (char const * error = matchmaker::set_library(library); nullptr != error)
+        {
+            std::cerr << "failed to load " << library << ": " << error << "\n";
+            return EXIT_FAILURE;
+        }
+#else
+        (void) library; // linked, nothing to load
+        matchmaker::set_library(nullptr);
+#endif
+
+        if (nullptr == script)
+        {
+            completable_shell_batch(std::cin);
+        }
+        else
+        {
+            std::ifstream in{script};
+            if (!in)
+            {
+                std::cerr << "failed to open " << script << "\n";
+                matchmaker::unset_library();
+                return EXIT_FAILURE;
+            }
+            completable_shell_batch(in);
+        }
+
+        std::cout << std::flush;
+        matchmaker::unset_library();
+
+        return EXIT_SUCCESS;
+    }
+
+    bool is_shell_key(int ch)
+    {
+        return ch == '$' || ch == '~' || ch == '`';
+    }
+
+    // printable ascii that can be forwarded to AbstractTab::on_printable_run()
+    bool is_run_key(int ch)
+    {
+        return ch > 31 && ch < 127 && ch != ',' && !is_shell_key(ch);
+    }
+
+    // what is left for the caller of dispatch_key() to do
+    enum key_action
+    {
+        KEY_HANDLED,
+        KEY_SHELL,  // enter shell mode, keys typed ahead of it are dropped
+        KEY_ESCAPE  // a lone escape, which quits unless followed by another key
+    };
+
+    /**
+     * Hand a key to the active tab, together with the printable keys following it as a single run
+     *
+     * @param[in] keys Keys read for one draw
+     * @param[in] count Number of keys
+     * @param[in,out] i Index of the key to handle, left at the last key handled
+     * @param[out] run Storage for runs of printable keys
+     * @returns What the caller still has to do
+     */
+    key_action dispatch_key(int const * keys, int count, int & i, std::string & run)
+    {
+        if (AbstractTab::get_active_tab().is_nil()) // should be impossible
+            return KEY_HANDLED;
+
+        AbstractTab * active_tab = AbstractTab::get_active_tab().as_AbstractTab();
+        if (nullptr == active_tab) // should be impossible
+            return KEY_HANDLED;
+
+        int const ch = keys[i];
+
+        // consecutive printable keys are forwarded as a single run
+        if (is_run_key(ch))
+        {
+            run.clear();
+            while (i < count && is_run_key(keys[i]))
+                run += (char) keys[i++];
+            --i;
+
+            active_tab->on_printable_run(run.c_str(), (int) run.length());
+            return KEY_HANDLED;
+        }
+
+        if (is_shell_key(ch))
+            return KEY_SHELL;
+
+        if (ch == ESC)
+        {
+            // escape sequence (alt + key) is ignored
+            if (i + 1 < count)
+            {
+                ++i;
+                return KEY_HANDLED;
+            }
+
+            return KEY_ESCAPE;
+        }
+
+        active_tab->on_KEY(ch);
+
+        return KEY_HANDLED;
+    }
+
+    // the tabs and the windows shown on all of them, wired up as neighbors with the first tab active
+    struct tab_set
+    {
+        tab_set(tab_set const &) = delete;
+        tab_set & operator=(tab_set const &) = delete;
+
+        tab_set()
+            : tab_desc_win{std::make_shared<TabDescriptionWindow>()}
+            , indicator_win{std::make_shared<IndicatorWindow>()}
+            , cta{tab_desc_win, indicator_win}
+            , sta{tab_desc_win, indicator_win}
+#ifdef MM_DYNAMIC_LOADING
+            , mta{tab_desc_win, indicator_win}
+#endif
+        {
+            cta()->set_left_neighbor(sta()->as_handle());
+            sta()->set_right_neighbor(cta()->as_handle());
+
+#ifdef MM_DYNAMIC_LOADING
+            mta()->set_right_neighbor(sta()->as_handle());
+            sta()->set_left_neighbor(mta()->as_handle());
+            AbstractTab::set_active_tab(mta()->as_handle());
+#else
+            AbstractTab::set_active_tab(cta()->as_handle());
+#endif
+        }
+
+        std::shared_ptr<TabDescriptionWindow> tab_desc_win;
+        std::shared_ptr<IndicatorWindow> indicator_win;
+
+        CompletableTabAgent cta;
+        SettingsTabAgent sta;
+#ifdef MM_DYNAMIC_LOADING
+        MatchmakerTabAgent mta;
+#endif
+    };
+
+    int const REPLAY_DEFAULT_WORST{10};
+
+    /**
+     * Replay a recorded session (see keystroke_log) against a terminal writing to /dev/null, or against a
+     * GridRenderer to leave out the terminal's cost, and report how long handling the keys and drawing
+     * took, see latency_report
+     *
+     * @param[in] argc Number of arguments following --replay
+     * @param[in] argv Arguments following --replay:
+     *     <log> [--paced] [--grid [--screen]] [--worst <count>] [--json | --tsv]
+     * @returns The process exit status
+     */
+    int run_replay(int argc, char ** argv)
+    {
+        char const * path{nullptr};
+        bool paced{false};
+        bool grid{false};
+        bool screen_dump{false};
+        int worst_count{REPLAY_DEFAULT_WORST};
+        output_format::Type format{output_format::text::grab()};
+        bool usage{false};
+
+        for (int i = 0; i < argc; ++i)
+        {
+            std::string const arg{argv[i]};
+            if (arg == "--paced")
+                paced = true;
+            else if (arg == "--grid")
+                grid = true;
+            else if (arg == "--screen")
+                screen_dump = true;
+            else if (arg == "--worst" && i + 1 < argc)
+                worst_count = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--json")
+                format = output_format::json::grab();
+            else if (arg == "--tsv")
+                format = output_format::tsv::grab();
+            else if (nullptr == path)
+                path = argv[i];
+            else
+                usage = true;
+        }
+        if (nullptr == path || usage || (screen_dump && !grid))
+        {
+            std::cerr << "usage: completable --replay <log> [--paced] [--grid [--screen]] [--worst <count>]"
+                      << " [--json | --tsv]\n";
+            return EXIT_FAILURE;
+        }
+
+        keystroke_log::session s;
+        std::string error;
+        if (!keystroke_log::load(path, s, error))
+        {
+            std::cerr << error << "\n";
+            return EXIT_FAILURE;
+        }
+
+        FILE * null_out{nullptr};
+        FILE * null_in{nullptr};
+        SCREEN * screen{nullptr};
+        std::unique_ptr<GridRenderer> grid_renderer;
+
+        if (grid)
+        {
+            grid_renderer = std::make_unique<GridRenderer>(s.rows, s.cols);
+            Renderer::set(grid_renderer.get());
+        }
+        else
+        {
+            null_out = std::fopen("/dev/null", "w");
+            null_in = std::fopen("/dev/null", "r");
+            if (nullptr == null_out || nullptr == null_in)
+            {
+                std::cerr << "failed to open /dev/null\n";
+                return EXIT_FAILURE;
+            }
+
+            // the recorded terminal type if known here, so that drawing emits the same escape sequences
+            if (!s.term.empty())
+                screen = newterm(s.term.c_str(), null_out, null_in);
+            if (nullptr == screen)
+                screen = newterm(nullptr, null_out, null_in);
+            if (nullptr == screen)
+                screen = newterm("xterm", null_out, null_in);
+            if (nullptr == screen)
+            {
+                std::cerr << "failed to set up a terminal for replaying\n";
+                return EXIT_FAILURE;
+            }
+            set_term(screen);
+            noecho();
+            curs_set(FALSE);
+            resizeterm(s.rows, s.cols);
+        }
+
+        // before any thread is started
+        event_loop::init();
+
+#ifndef MM_DYNAMIC_LOADING
+        matchmaker::set_library(nullptr);
+#endif
+
+        latency_report::replay_summary summary{0, 0, 0, 0, grid ? "grid" : "terminal", 0};
+        std::vector<latency_report::sample> samples;
+        samples.reserve(s.batches.size());
+        {
+            tab_set tabs;
+            std::string run;
+            run.reserve(KEY_BATCH_CAPACITY);
+
+            int root_y{0};
+            int root_x{0};
+            Renderer::get().get_size(root_y, root_x);
+
+            // same as the main loop: check the size, collect background work, draw
+            auto const draw = [&](bool resized_draw)
+            {
+                AbstractTab * active_tab = AbstractTab::get_active_tab().as_AbstractTab();
+                if (nullptr == active_tab) // should be impossible
+                    return;
+
+                int const prev_root_y{root_y};
+                int const prev_root_x{root_x};
+                Renderer::get().get_size(root_y, root_x);
+                if (root_y != prev_root_y || root_x != prev_root_x)
+                {
+                    active_tab->resize();
+                    resized_draw = true;
+                }
+
+                tabs.cta.collect_background_work();
+                active_tab->draw(resized_draw);
+
+                if (grid)
+                    summary.changed_cells += grid_renderer->get_changed_cells();
+            };
+
+            draw(true);
+
+            auto const started = std::chrono::steady_clock::now();
+            for (int b = 0; b < (int) s.batches.size(); ++b)
+            {
+                auto const & batch = s.batches[b];
+                if (paced)
+                    std::this_thread::sleep_until(started + std::chrono::nanoseconds(batch.at_ns));
+
+                if (batch.kind == keystroke_log::RESIZE)
+                {
+                    // picked up by the next draw
+                    if (grid)
+                        grid_renderer->set_size(batch.rows, batch.cols);
+                    else
+                        resizeterm(batch.rows, batch.cols);
+                    ++summary.resizes;
+                    continue;
+                }
+
+                int const count = (int) batch.keys.size();
+                auto const compute_start = std::chrono::steady_clock::now();
+                for (int i = 0; i < count; ++i)
+                {
+                    // shell sessions are not recorded, whatever was typed ahead of them was dropped
+                    if (dispatch_key(batch.keys.data(), count, i, run) == KEY_SHELL)
+                    {
+                        summary.skipped_keys += count - i;
+                        break;
+                    }
+                }
+                auto const draw_start = std::chrono::steady_clock::now();
+                draw(false);
+                auto const draw_stop = std::chrono::steady_clock::now();
+
+                summary.keys += count;
+                samples.push_back({
+                    b,
+                    (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(draw_start - compute_start).count(),
+                    (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(draw_stop - draw_start).count()
+                });
+            }
+            summary.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - started
+            ).count();
+
+            if (!grid)
+                endwin();
+        }
+
+        if (grid)
+        {
+            Renderer::set(nullptr);
+        }
+        else
+        {
+            delscreen(screen);
+            std::fclose(null_in);
+            std::fclose(null_out);
+        }
+
+        matchmaker::unset_library();
+
+        latency_report::write(std::cout, format, s, summary, samples, worst_count);
+
+        // the last frame, for comparing builds
+        if (screen_dump)
+        {
+            int rows{0};
+            int cols{0};
+            grid_renderer->get_size(rows, cols);
+
+            std::cout << "\n";
+            for (int row = 0; row < rows; ++row)
+                std::cout << grid_renderer->row_text(row) << "\n";
+        }
+        std::cout << std::flush;
+
+        return EXIT_SUCCESS;
+    }
+}
+
+
+
 int main(int argc, char ** argv)
 {
-    if (argc == 2)
+    if (argc >= 2 && std::strcmp(argv[1], "--batch") == 0)
+        return run_batch(argc - 2, argv + 2);
+
+    if (argc >= 2 && std::strcmp(argv[1], "--replay") == 0)
+        return run_replay(argc - 2, argv + 2);
+
+    char const * record_path{nullptr};
+    for (int i = 1; i < argc; ++i)
     {
-        std::string const a1{argv[1]};
-        if (a1 == "borders_disabled")
+        std::string const arg{argv[i]};
+        if (arg == "borders_disabled")
             EnablednessSetting::Borders::grab().set_enabledness(Enabledness::Disabled::grab());
+        else if (arg == "--record" && i + 1 < argc)
+            record_path = argv[++i];
     }
 
+    // before any thread is started
+    event_loop::init();
+
 #ifndef MM_DYNAMIC_LOADING
     matchmaker::set_library(nullptr); // disable dynamic loading, use linking instead
 #endif
@@ -43,30 +500,29 @@ int main(int argc, char ** argv)
     int prev_root_y{root_y};
     int prev_root_x{root_x};
 
-    auto tab_desc_win = std::make_shared<TabDescriptionWindow>();
-    auto indicator_win = std::make_shared<IndicatorWindow>();
-
-    CompletableTabAgent cta{tab_desc_win, indicator_win};
-
-    SettingsTabAgent sta{tab_desc_win, indicator_win};
-
-    cta()->set_left_neighbor(sta()->as_handle());
-    sta()->set_right_neighbor(cta()->as_handle());
+    if (nullptr != record_path && !keystroke_log::start_recording(record_path, root_y, root_x))
+    {
+        endwin();
+        std::cerr << "failed to record to " << record_path << "\n";
+        return EXIT_FAILURE;
+    }
 
-#ifdef MM_DYNAMIC_LOADING
-    MatchmakerTabAgent mta{tab_desc_win, indicator_win};
-    mta()->set_right_neighbor(sta()->as_handle());
-    sta()->set_left_neighbor(mta()->as_handle());
-    AbstractTab::set_active_tab(mta()->as_handle());
-#else
-    AbstractTab::set_active_tab(cta()->as_handle());
-#endif
+    tab_set tabs;
 
 
     bool resized_draw{true};
     int ch{0};
     AbstractTab * active_tab{nullptr};
 
+    unsigned events{0};
+    bool resize_pending{false};
+    auto resize_settled_at = std::chrono::steady_clock::now();
+    int keys[KEY_BATCH_CAPACITY];
+    int key_count{0};
+    std::string run;
+    run.reserve(KEY_BATCH_CAPACITY);
+    bool quit{false};
+
     while (true)
     {
         if (AbstractTab::get_active_tab().is_nil()) // should be impossible
@@ -87,41 +543,91 @@ int main(int argc, char ** argv)
         }
         // ***********************************
 
+        tabs.cta.collect_background_work();
+
         active_tab->draw(resized_draw);
         resized_draw = false;
 
+        // sleep until there is something to do, unless keys were left queued by the previous batch
+        if (key_count == KEY_BATCH_CAPACITY)
+        {
+            events = event_loop::INPUT;
+        }
+        else if (resize_pending)
+        {
+            auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                resize_settled_at - std::chrono::steady_clock::now()
+            );
+            events = event_loop::wait(remaining.count() < 0 ? 0 : (int) remaining.count());
+        }
+        else
+        {
+            events = event_loop::wait();
+        }
+
+        // every resize event restarts the wait for the size to settle
+        if (events & event_loop::RESIZE)
+        {
+            resize_pending = true;
+            resize_settled_at = std::chrono::steady_clock::now() + RESIZE_SETTLE;
+        }
+
+        bool const resized = resize_pending && std::chrono::steady_clock::now() >= resize_settled_at;
+        if (resized)
+        {
+            resize_pending = false;
+            update_terminal_size(); // picked up by getmaxyx() above
+            keystroke_log::record_resize(LINES, COLS);
+        }
+
         // a window is needed for keyboard input
         // tab_desc_win is on all tabs and is always enabled so it is the chosen one
-        ch = wgetch(tab_desc_win->get_WINDOW());
+        // all keys typed ahead (pasting, key repeat) are handled before the next draw
+        // (resizeterm() may have queued a KEY_RESIZE, exec_long_task() may have handed keys back)
+        key_count = 0;
+        if ((events & (event_loop::INPUT | event_loop::WAKEUP)) || resized)
+            key_count = read_keys(tabs.tab_desc_win->get_WINDOW(), keys, KEY_BATCH_CAPACITY);
+        keystroke_log::record_keys(keys, key_count);
 
-        // enter shell mode?
-        if (ch == '$' || ch == '~' || ch == '`')
+        for (int i = 0; i < key_count; ++i)
         {
-            def_prog_mode();
-            endwin();
+            key_action const action = dispatch_key(keys, key_count, i, run);
 
-            completable_shell();
+            // enter shell mode?
+            if (action == KEY_SHELL)
+            {
+                def_prog_mode();
+                endwin();
 
-            reset_prog_mode();
-            resized_draw = true;
-        }
-        else if (ch == ESC)
-        {
-            nodelay(tab_desc_win->get_WINDOW(), true);
-            ch = wgetch(tab_desc_win->get_WINDOW());
-            nodelay(tab_desc_win->get_WINDOW(), false);
+                completable_shell();
 
-            if (ch == ERR)
+                reset_prog_mode();
+                resized_draw = true;
+
+                // keys typed ahead of shell mode are dropped
                 break;
+            }
+
+            // a lone escape quits
+            if (action == KEY_ESCAPE)
+            {
+                nodelay(tabs.tab_desc_win->get_WINDOW(), true);
+                ch = wgetch(tabs.tab_desc_win->get_WINDOW());
+                nodelay(tabs.tab_desc_win->get_WINDOW(), false);
+
+                if (ch == ERR)
+                    quit = true;
+                break;
+            }
         }
-        else
-        {
-            active_tab->on_KEY(ch);
-        }
+
+        if (quit)
+            break;
     }
 
     endwin();
 
+    keystroke_log::stop_recording();
 
     matchmaker::unset_library();
 
@@ -0,0 +1,207 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <ncurses.h>
+
+#include "CompletableTabAgent.h"
+#include "GridRenderer.h"
+#include "IndicatorWindow.h"
+#include "TabDescriptionWindow.h"
+#include "event_loop.h"
+#include "frame.h"
+#include "key_codes.h"
+#include "matchmaker.h"
+#include "thread_pool.h"
+
+
+
+/*
+    completable_alloc_check scrolls the completion list of the completable tab on a GridRenderer and
+    fails if handling the keys or drawing allocates on the heap. Scrolling through a list that is
+    already cached should only move indexes around and stage cells.
+
+    Allocations are counted by replacing the global operator new, only on the thread handling the keys
+    so that pool threads finishing background work do not count.
+
+    It also fails if frames drawn without any input redraw a window, since only a change should cause
+    a redraw.
+*/
+
+namespace
+{
+    int const SCREEN_ROWS{50};
+    int const SCREEN_COLS{160};
+    int const DEFAULT_ITERATIONS{1000};
+    int const IDLE_FRAMES{10};
+
+    // keys handled, each followed by a draw, once to warm up and then with allocations counted
+    int const KEYS[]{KEY_DOWN, PAGE_DOWN, KEY_DOWN, END, HOME};
+
+    thread_local bool counting{false};
+    std::atomic<uint64_t> allocations{0};
+
+    void * allocate(std::size_t size)
+    {
+        if (counting)
+            ++allocations;
+
+        if (void * p = std::malloc(size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc{};
+    }
+
+    void * allocate(std::size_t size, std::align_val_t alignment)
+    {
+        if (counting)
+            ++allocations;
+
+        std::size_t const a = (std::size_t) alignment;
+        if (void * p = std::aligned_alloc(a, (size + a - 1) / a * a))
+            return p;
+
+        throw std::bad_alloc{};
+    }
+
+
+    // everything posted so far has finished and was collected by the tab
+    void wait_for_background_work(CompletableTabAgent & cta)
+    {
+        while (true)
+        {
+            bool idle{true};
+            for (int l = 0; l < thread_pool::LANE_COUNT; ++l)
+            {
+                thread_pool::lane_stats ls;
+                thread_pool::collect_stats((thread_pool::lane) l, &ls);
+                idle = idle && ls.completed == ls.submitted;
+            }
+            if (idle)
+                break;
+
+            if (!thread_pool::run_pending_task())
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        cta.collect_background_work();
+    }
+
+
+    void press_keys(AbstractTab * tab)
+    {
+        for (int key : KEYS)
+        {
+            tab->on_KEY(key);
+            tab->draw(false);
+        }
+    }
+}
+
+
+void * operator new(std::size_t size) { return allocate(size); }
+void * operator new[](std::size_t size) { return allocate(size); }
+void * operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void * operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void operator delete(void * p) noexcept { std::free(p); }
+void operator delete[](void * p) noexcept { std::free(p); }
+void operator delete(void * p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::size_t) noexcept { std::free(p); }
+void operator delete(void * p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { std::free(p); }
+
+
+
+int main(int argc, char ** argv)
+{
+    char const * library{nullptr};
+    int iterations{DEFAULT_ITERATIONS};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        bool const has_value = i + 1 < argc;
+
+        if (arg == "--library" && has_value)
+            library = argv[++i];
+        else if (arg == "--iterations" && has_value)
+            iterations = std::atoi(argv[++i]);
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--library <libmatchmaker.so>] [--iterations <count>]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations <= 0)
+    {
+        std::cerr << "the iteration count must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+    GridRenderer grid{SCREEN_ROWS, SCREEN_COLS};
+    Renderer::set(&grid);
+
+    // before any thread is started
+    event_loop::init();
+
+#ifdef MM_DYNAMIC_LOADING
+    if (nullptr == library)
+    {
+        std::cerr << "--library <libmatchmaker.so> is needed when built for dynamic loading\n";
+        return EXIT_FAILURE;
+    }
+    if (char const * error = matchmaker::set_library(library); nullptr != error)
+    {
+        std::cerr << "failed to load " << library << ": " << error << "\n";
+        return EXIT_FAILURE;
+    }
+#else
+    (void) library; // linked, nothing to load
+    matchmaker::set_library(nullptr);
+#endif
+
+    uint64_t counted{0};
+    uint64_t idle_draws{0};
+    {
+        CompletableTabAgent cta{std::make_shared<TabDescriptionWindow>(), std::make_shared<IndicatorWindow>()};
+        AbstractTab::set_active_tab(cta()->as_handle());
+        AbstractTab * tab = cta();
+
+        tab->draw(true);
+        wait_for_background_work(cta);
+        tab->draw(false);
+
+        // the word cache is built and every row has been drawn once
+        press_keys(tab);
+
+        counting = true;
+        for (int i = 0; i < iterations; ++i)
+            press_keys(tab);
+        counting = false;
+
+        counted = allocations;
+
+        // recording draws allocates, so only after counting
+        frame::set_stats_enabled(true);
+        frame::reset_stats();
+        for (int i = 0; i < IDLE_FRAMES; ++i)
+            tab->draw(false);
+        frame::frame_stats fs;
+        frame::collect_stats(&fs);
+        idle_draws = fs.windows_drawn;
+        frame::set_stats_enabled(false);
+    }
+
+    matchmaker::unset_library();
+    Renderer::set(nullptr);
+
+    std::cout << "allocations while scrolling: " << counted << " (" << iterations << " iterations)\n"
+              << "windows drawn without input: " << idle_draws << " (" << IDLE_FRAMES << " frames)\n";
+
+    return counted == 0 && idle_draws == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,294 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "AbstractListWindow.h"
+#include "CompletionStack.h"
+#include "InputWindow.h"
+#include "RecordWriter.h"
+#include "WordStack.h"
+#include "bench.h"
+#include "matchmaker.h"
+#include "thread_pool.h"
+#include "word_filter.h"
+
+
+
+/*
+    completable_bench times what typing costs without a terminal: rebuilding the root completion,
+    pushing letters, length completion, tab completion (common prefix), the filtering done by list
+    windows and filter evaluation, each across prefix depths and filter configurations.
+
+    Samples use a fixed seed and results are printed as records (see RecordWriter) so that runs of
+    different builds can be compared with diff.
+*/
+
+namespace
+{
+    int const DEFAULT_ITERATIONS{10000};
+    int const DEFAULT_ROOT_ITERATIONS{20};
+    int const SAMPLE_SIZE{1024};
+    uint32_t const SEED{1};
+
+    // prefixes of 1 to MAX_DEPTH letters are measured
+    int const MAX_DEPTH{4};
+
+    volatile int sink;
+
+
+    // a list window showing the synonyms of the selected word like SynonymWindow, never drawn, so that
+    // get_words() is measured exactly as the windows on screen run it
+    class synonym_list : public AbstractListWindow
+    {
+    public:
+        using AbstractListWindow::AbstractListWindow;
+
+        std::vector<int> const & words() const { return get_words(); }
+
+    private:
+        void title(std::string & t) final { t.clear(); }
+        void resize_hook() final {}
+        int & display_start() final { return cs.top().syn_display_start; }
+        bool apply_filter() const final { return true; }
+
+        void unfiltered_words(int index, int const * * words, int * count) const final
+        {
+            matchmaker::synonyms(index, words, count);
+        }
+    };
+
+
+    std::vector<std::pair<std::string, word_filter>> filter_configurations()
+    {
+        std::vector<std::pair<std::string, word_filter>> configurations;
+
+        configurations.emplace_back("none", word_filter{});
+
+        word_filter hide_names_and_places;
+        hide_names_and_places.direction = filter_direction::exclusive::grab();
+        hide_names_and_places.logic = filter_logic::or_logic::grab();
+        hide_names_and_places.attributes.set(word_attribute::name::grab());
+        hide_names_and_places.attributes.set(word_attribute::place::grab());
+        configurations.emplace_back("hide_names_places", hide_names_and_places);
+
+        word_filter only_compounds;
+        only_compounds.direction = filter_direction::inclusive::grab();
+        only_compounds.logic = filter_logic::and_logic::grab();
+        only_compounds.attributes.set(word_attribute::compound::grab());
+        configurations.emplace_back("only_compounds", only_compounds);
+
+        return configurations;
+    }
+
+
+    void wait_for_length_completion(CompletionStack & cs)
+    {
+        while (cs.top().length_completion_pending)
+            if (!cs.collect() && !thread_pool::run_pending_task())
+                std::this_thread::yield();
+    }
+
+
+    // pop back to the root and push the first depth letters of prefix
+    void prepare_stack(CompletionStack & cs, std::string const & prefix, int depth)
+    {
+        while (cs.count() > 1)
+            cs.pop();
+        cs.push(prefix.c_str(), std::min(depth, (int) prefix.length()));
+        wait_for_length_completion(cs);
+    }
+
+
+    // words passing the filter with at least MAX_DEPTH letters, reachable by pushing their letters
+    std::vector<std::string> sample_words(CompletionStack const & cs)
+    {
+        std::vector<int> candidates;
+        for (int w : cs.top().standard_completion)
+        {
+            int length{0};
+            matchmaker::at(w, &length);
+            if (length >= MAX_DEPTH)
+                candidates.push_back(w);
+        }
+
+        std::vector<std::string> sample;
+        if (candidates.empty())
+            return sample;
+
+        std::mt19937 rng{SEED};
+        std::uniform_int_distribution<int> pick{0, (int) candidates.size() - 1};
+        for (int i = 0; i < SAMPLE_SIZE; ++i)
+            sample.emplace_back(matchmaker::at(candidates[pick(rng)], nullptr));
+
+        return sample;
+    }
+
+
+    void write_result(RecordWriter & records, std::string const & filter, int depth, bench::result const & r)
+    {
+        records.begin("bench");
+        records.string_field("workload", r.workload);
+        records.string_field("filter", filter);
+        records.int_field("depth", depth);
+        records.int_field("ops", r.ops);
+        records.int_field("mean_ns", (int64_t) (r.ns_per_op + 0.5));
+        records.int_field("p50_ns", r.p50_ns);
+        records.int_field("p99_ns", r.p99_ns);
+        records.int_field("p999_ns", r.p999_ns);
+        records.int_field("ops_per_s", (int64_t) (r.ops_per_s + 0.5));
+        records.end();
+    }
+
+
+    void run(RecordWriter & records, int iterations, int root_iterations)
+    {
+        int const warm_up = iterations / 10;
+
+        // depth dependent workloads get slower with shorter prefixes, so they run fewer iterations
+        int const completion_iterations = std::max(1, iterations / 10);
+
+        for (auto const & [filter_name, wf] : filter_configurations())
+        {
+            CompletionStack cs{wf};
+            wait_for_length_completion(cs);
+
+            auto const words = sample_words(cs);
+            if (words.empty())
+                continue;
+            int const n = (int) words.size();
+
+            write_result(records, filter_name, 0, bench::measure("root_rebuild", 1, root_iterations,
+                [&](int) { cs.clear_all(); wait_for_length_completion(cs); }
+            ));
+
+            for (int depth = 1; depth <= MAX_DEPTH; ++depth)
+            {
+                // the keystroke itself, length completion may still be running in the background
+                write_result(records, filter_name, depth, bench::measure("push", warm_up, iterations,
+                    [&](int i) { prepare_stack(cs, words[i % n], depth - 1); },
+                    [&](int i) { cs.push(words[i % n][depth - 1]); }
+                ));
+
+                write_result(records, filter_name, depth, bench::measure(
+                    "length_completion", completion_iterations / 10, completion_iterations,
+                    [&](int i) { prepare_stack(cs, words[i % n], depth - 1); },
+                    [&](int i) { cs.push(words[i % n][depth - 1]); wait_for_length_completion(cs); }
+                ));
+
+                write_result(records, filter_name, depth, bench::measure(
+                    "tab_lcp", completion_iterations / 10, completion_iterations,
+                    [&](int i) { prepare_stack(cs, words[i % n], depth); },
+                    [&](int) { sink = cs.common_prefix_length(); }
+                ));
+            }
+
+            // list window words for a selection that changed (a cache miss) and for the same one (a hit)
+            prepare_stack(cs, words[0], 0);
+            WordStack ws;
+            InputWindow input_win{cs, ws};
+            word_filter list_filter{wf};
+            synonym_list list{cs, ws, input_win, list_filter};
+
+            int const root_size = (int) cs.top().standard_completion.size();
+            std::mt19937 rng{SEED};
+            std::uniform_int_distribution<int> pick{0, root_size - 1};
+            std::vector<int> selections(SAMPLE_SIZE);
+            for (auto & selection : selections)
+                selection = pick(rng);
+
+            write_result(records, filter_name, 0, bench::measure("get_words", warm_up, iterations,
+                [&](int i)
+                {
+                    cs.top().display_start = selections[i % SAMPLE_SIZE];
+                    sink = (int) list.words().size();
+                }
+            ));
+
+            write_result(records, filter_name, 0, bench::measure("get_words_cached", warm_up, iterations,
+                [&](int) { sink = (int) list.words().size(); }
+            ));
+
+            auto const & all_words = cs.top().standard_completion;
+            write_result(records, filter_name, 0, bench::measure("filter_passes", warm_up, iterations,
+                [&](int i) { sink = wf.passes(all_words[i % all_words.size()]); }
+            ));
+        }
+    }
+}
+
+
+
+int main(int argc, char ** argv)
+{
+    char const * library{nullptr};
+    int iterations{DEFAULT_ITERATIONS};
+    int root_iterations{DEFAULT_ROOT_ITERATIONS};
+    output_format::Type format{output_format::tsv::grab()};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string const arg{argv[i]};
+        bool const has_value = i + 1 < argc;
+
+        if (arg == "--library" && has_value)
+            library = argv[++i];
+        else if (arg == "--iterations" && has_value)
+            iterations = std::atoi(argv[++i]);
+        else if (arg == "--root-iterations" && has_value)
+            root_iterations = std::atoi(argv[++i]);
+        else if (arg == "--json")
+            format = output_format::json::grab();
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--library <libmatchmaker.so>] [--iterations <count>]"
+                      << " [--root-iterations <count>] [--json]\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (iterations <= 0 || root_iterations <= 0)
+    {
+        std::cerr << "iteration counts must be positive\n";
+        return EXIT_FAILURE;
+    }
+
+#ifdef MM_DYNAMIC_LOADING
+    if (nullptr == library)
+    {
+        std::cerr << "--library <libmatchmaker.so> is needed when built for dynamic loading\n";
+        return EXIT_FAILURE;
+    }
+    if (char const * error = matchmaker::set_library(library); nullptr != error)
+    {
+        std::cerr << "failed to load " << library << ": " << error << "\n";
+        return EXIT_FAILURE;
+    }
+#else
+    (void) library; // linked, nothing to load
+    matchmaker::set_library(nullptr);
+#endif
+
+    RecordWriter records{std::cout};
+    records.set_format(format);
+
+    records.begin("run");
+    records.int_field("words", matchmaker::count());
+    thread_pool::set_size(0);
+    records.int_field("threads", thread_pool::size());
+    records.int_field("iterations", iterations);
+    records.int_field("root_iterations", root_iterations);
+    records.int_field("seed", SEED);
+    records.end();
+
+    run(records, iterations, root_iterations);
+
+    std::cout << std::flush;
+    matchmaker::unset_library();
+
+    return EXIT_SUCCESS;
+}
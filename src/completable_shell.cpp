@@ -1,20 +1,374 @@
 #include "completable_shell.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "AbstractListWindow.h"
+#include "RecordWriter.h"
+#include "Settings.h"
+#include "bench.h"
+#include "book_render.h"
+#include "concordance.h"
+#include "exec_long_task_with_busy_animation.h"
+#include "frame.h"
 #include "matchmaker.h"
+#include "memory_accounting.h"
+#include "thread_pool.h"
 
 
 
-void completable_shell()
+// :bench defaults, a fixed seed keeps random samples comparable between runs and builds
+static int const BENCH_DEFAULT_ITERATIONS{100000};
+static int const BENCH_SAMPLE_SIZE{1024};
+static uint32_t const BENCH_SEED{1};
+
+// characters of context shown on each side of words found by :loc
+static int const KWIC_DEFAULT_WIDTH{30};
+
+
+static void print_prompt(bool help)
+{
+    std::cout << "\n\n";
+    if (help)
+        std::cout << "{ just enter a word for lookup                                                }\n"
+                  << "{ prefix the word with '!' for completion                                     }\n"
+                  << "{ use  :it <index> <count>        to iterate <count> terms from <index>       }\n"
+                  << "{ use  :pos <word>                for parts of speech of <word>               }\n"
+                  << "{ use  :s <word>                  for synonyms of <word>                      }\n"
+                  << "{ use  :a <word>                  for antonyms of <word>                      }\n"
+                  << "{ use  :itl <index> <count>       like ':it' but uses length indexes          }\n"
+                  << "{ use  :len                       to list length index offsets                }\n"
+                  << "{ use  :e <index>                 to list embedded terms                      }\n"
+                  << "{ use  :books                     to list books                               }\n"
+                  << "{ use  :book <index> [file]       to read a book or to write it to a file     }\n"
+                  << "{ use  :loc <word|@file> ...      to locate words or indexes in the books     }\n"
+                  << "{ use  :kwic [width]              context shown by :loc, 0 for none           }\n"
+                  << "{ use  :p <b> <ch> <p> <w>        show a word's parent and index within parent}\n"
+                  << "{ use  :stats [on|off|reset]      show or control call and frame statistics   }\n"
+                  << "{ use  :mem [reset]               bytes held per component, library mappings  }\n"
+                  << "{ use  :bench [count] [words]     time lookups and completions, random words  }\n"
+                  << "{ use  :fmt [text|json|tsv]       print results as text or as records         }\n"
+                  << "{ use  :curses                    return to curses mode                       }\n"
+                  << "{ use  :q                         to quit                                     }\n"
+                  << "{ use  :help                      to toggle help                              }\n"
+                  << "matchmaker (" << matchmaker::count() << ") $  ";
+    else
+        std::cout << "matchmaker (" << matchmaker::count() << ") { enter :help for help } $  ";
+}
+
+
+// fields shared by all records about a looked up word
+static void write_word_fields(RecordWriter & records, std::string_view query, int index, bool found)
+{
+    records.string_field("query", query);
+    records.int_field("index", index);
+    records.bool_field("found", found);
+    records.string_field("word", index < matchmaker::count() ? matchmaker::at(index, nullptr) : "");
+}
+
+
+static void write_lookup(RecordWriter & records, std::string const & query)
+{
+    bool found{false};
+    int const index = matchmaker::lookup(query.c_str(), &found);
+
+    records.begin("lookup");
+    write_word_fields(records, query, index, found);
+    records.int_field("length_index", index < matchmaker::count() ? matchmaker::as_longest(index) : -1);
+    records.end();
+}
+
+
+static void write_completion(RecordWriter & records, std::string const & prefix)
+{
+    int start{0};
+    int length{0};
+    matchmaker::complete(prefix.c_str(), &start, &length);
+
+    records.begin("completion");
+    records.string_field("prefix", prefix);
+    records.int_field("start", start);
+    records.int_field("count", length);
+    records.begin_list("words");
+    for (int i = start; i < start + length; ++i)
+    {
+        int word_length{0};
+        char const * word = matchmaker::at(i, &word_length);
+        records.list_item(std::string_view{word, (size_t) word_length});
+    }
+    records.end_list();
+    records.end();
+}
+
+
+// synonyms, antonyms and definitions all provide a list of terms for a word
+static void write_related_terms(RecordWriter & records, char const * type, std::string const & query,
+                                void (*related)(int, int const * *, int *))
+{
+    bool found{false};
+    int const index = matchmaker::lookup(query.c_str(), &found);
+
+    int const * terms{nullptr};
+    int count{0};
+    if (index < matchmaker::count())
+        related(index, &terms, &count);
+
+    records.begin(type);
+    write_word_fields(records, query, index, found);
+    records.term_list("terms", terms, count);
+    records.end();
+}
+
+
+static void write_parts_of_speech(RecordWriter & records, std::string const & query)
+{
+    bool found{false};
+    int const index = matchmaker::lookup(query.c_str(), &found);
+
+    char const * const * pos{nullptr};
+    int8_t const * flagged{nullptr};
+    int pos_count{0};
+    if (index < matchmaker::count())
+        matchmaker::parts_of_speech(index, &pos, &flagged, &pos_count);
+
+    records.begin("pos");
+    write_word_fields(records, query, index, found);
+    records.begin_list("pos");
+    for (int i = 0; i < pos_count; ++i)
+        if (flagged[i])
+            records.list_item(pos[i]);
+    records.end_list();
+    records.end();
+}
+
+
+static void write_embedded(RecordWriter & records, int index)
+{
+    int const * embedded_terms{nullptr};
+    int count{0};
+    matchmaker::embedded(index, &embedded_terms, &count);
+
+    records.begin("embedded");
+    records.int_field("index", index);
+    records.string_field("word", matchmaker::at(index, nullptr));
+    records.term_list("terms", embedded_terms, count);
+    records.end();
+}
+
+
+// a term by its index, for :it and :itl
+static void write_term(RecordWriter & records, int index)
+{
+    int length{0};
+    char const * word = matchmaker::at(index, &length);
+
+    records.begin("term");
+    records.int_field("index", index);
+    records.int_field("length_index", matchmaker::as_longest(index));
+    records.string_field("word", std::string_view{word, (size_t) length});
+    records.int_field("length", length);
+    records.end();
+}
+
+
+// one record per word length, where words of that length begin among the length indexes
+static void write_lengths(RecordWriter & records)
+{
+    int const * lengths{nullptr};
+    int lengths_count{0};
+    matchmaker::lengths(&lengths, &lengths_count);
+
+    for (int i = 0; i < lengths_count; ++i)
+    {
+        int index{0};
+        int count{0};
+        if (!matchmaker::length_location(lengths[i], &index, &count))
+            continue;
+
+        records.begin("length");
+        records.int_field("letters", lengths[i]);
+        records.int_field("index", index);
+        records.int_field("count", count);
+        records.end();
+    }
+}
+
+
+// the words of a title or author joined the way the text output prints them
+static std::string joined_terms(int const * terms, int count)
+{
+    std::string joined;
+    for (int t = 0; t < count; ++t)
+        joined += matchmaker::at(terms[t], nullptr);
+
+    return joined;
+}
+
+
+static void write_books(RecordWriter & records)
+{
+    for (int i = 0; i < matchmaker::book_count(); ++i)
+    {
+        int const * title{nullptr};
+        int title_count{0};
+        matchmaker::book_title(i, &title, &title_count);
+        int const * author{nullptr};
+        int author_count{0};
+        matchmaker::book_author(i, &author, &author_count);
+
+        records.begin("book");
+        records.int_field("book", i);
+        records.string_field("title", joined_terms(title, title_count));
+        records.string_field("author", joined_terms(author, author_count));
+        records.int_field("chapters", matchmaker::chapter_count(i));
+        records.end();
+    }
+}
+
+
+// one record per component, then one for the library's mappings and one for all mappings of the process
+static void write_memory(RecordWriter & records)
+{
+    for (int c = 0; c < memory_accounting::COMPONENT_COUNT; ++c)
+    {
+        memory_accounting::component_stats cs;
+        memory_accounting::collect_stats((memory_accounting::component) c, &cs);
+
+        records.begin("memory");
+        records.string_field("component", memory_accounting::component_name((memory_accounting::component) c));
+        records.int_field("bytes", (int64_t) cs.bytes);
+        records.int_field("peak_bytes", (int64_t) cs.peak_bytes);
+        records.int_field("accounts", (int64_t) cs.accounts);
+        records.end();
+    }
+
+    memory_accounting::mapping_stats library;
+    memory_accounting::mapping_stats process;
+    memory_accounting::collect_file_mappings(matchmaker::library_address(), &library);
+    memory_accounting::collect_process_mappings(&process);
+
+    for (auto const & [name, ms] : {std::pair{"library", &library}, std::pair{"process", &process}})
+    {
+        records.begin("mappings");
+        records.string_field("of", name);
+        records.string_field("path", ms->path);
+        records.int_field("mappings", (int64_t) ms->mappings);
+        records.int_field("size", (int64_t) ms->size);
+        records.int_field("rss", (int64_t) ms->rss);
+        records.int_field("pss", (int64_t) ms->pss);
+        records.int_field("private", (int64_t) ms->private_bytes);
+        records.end();
+    }
+}
+
+
+// a diagnostic, as an error record while records are written so that it cannot be mistaken for one
+static void write_error(RecordWriter & records, std::string_view message)
+{
+    if (records.get_format() == output_format::text::grab())
+    {
+        std::cout << message << "\n";
+        return;
+    }
+
+    records.begin("error");
+    records.string_field("message", message);
+    records.end();
+}
+
+
+// one record per occurrence
+static void write_locations(RecordWriter & records, int index, std::vector<concordance::occurrence> const & found)
+{
+    char const * word = matchmaker::at(index, nullptr);
+    for (auto const & o : found)
+    {
+        records.begin("location");
+        records.int_field("index", index);
+        records.string_field("word", word);
+        records.int_field("book", o.book);
+        records.int_field("chapter", o.chapter);
+        records.int_field("paragraph", o.paragraph);
+        records.int_field("word_index", o.word);
+        // empty without context, so that every location record has the same fields
+        records.string_field("left", o.left);
+        records.string_field("keyword", o.keyword);
+        records.string_field("right", o.right);
+        records.end();
+    }
+}
+
+
+// the words given to :loc, as indexes, words or @files listing one word per line
+static std::vector<int> parse_loc_terms(RecordWriter & records, std::vector<std::string> const & terms)
+{
+    std::vector<std::string> words;
+    for (size_t i = 1; i < terms.size(); ++i)
+    {
+        if (terms[i].empty())
+            continue;
+
+        if (terms[i][0] != '@')
+        {
+            words.push_back(terms[i]);
+            continue;
+        }
+
+        std::ifstream file{terms[i].substr(1)};
+        if (!file)
+        {
+            write_error(records, "failed to open " + terms[i].substr(1));
+            continue;
+        }
+        std::string word;
+        while (std::getline(file, word))
+            if (!word.empty())
+                words.push_back(word);
+    }
+
+    std::vector<int> indexes;
+    for (auto const & word : words)
+    {
+        int index{-1};
+        bool found{false};
+        if (std::all_of(word.begin(), word.end(), [](char ch) { return ch >= '0' && ch <= '9'; }))
+        {
+            try { index = std::stoi(word); } catch (...) { }
+            found = index >= 0 && index < matchmaker::count();
+        }
+        else
+        {
+            index = matchmaker::lookup(word.c_str(), &found);
+        }
+
+        if (found)
+            indexes.push_back(index);
+        else
+            write_error(records, "skipping unknown word '" + word + "'");
+    }
+
+    return indexes;
+}
+
+
+static void run_shell(std::istream & in, bool interactive)
 {
     int index{-1};
     bool found{false};
     bool help{false};
+    RecordWriter records{std::cout};
+    int kwic_width{KWIC_DEFAULT_WIDTH};
     std::vector<std::string const *> pos;
     int const MAX_INDEX_DIGITS =
         []()
@@ -28,36 +382,19 @@ void completable_shell()
 
     while (true)
     {
-        std::cout << "\n\n";
-        if (help)
-            std::cout << "{ just enter a word for lookup                                                }\n"
-                      << "{ prefix the word with '!' for completion                                     }\n"
-                      << "{ use  :it <index> <count>        to iterate <count> terms from <index>       }\n"
-                      << "{ use  :pos <word>                for parts of speech of <word>               }\n"
-                      << "{ use  :s <word>                  for synonyms of <word>                      }\n"
-                      << "{ use  :a <word>                  for antonyms of <word>                      }\n"
-                      << "{ use  :itl <index> <count>       like ':it' but uses length indexes          }\n"
-                      << "{ use  :len                       to list length index offsets                }\n"
-                      << "{ use  :e <index>                 to list embedded terms                      }\n"
-                      << "{ use  :books                     to list books                               }\n"
-                      << "{ use  :book <index>              to read a book                              }\n"
-                      << "{ use  :loc <index>               to locate all occurrences of a word         }\n"
-                      << "{ use  :p <b> <ch> <p> <w>        show a word's parent and index within parent}\n"
-                      << "{ use  :curses                    return to curses mode                       }\n"
-                      << "{ use  :q                         to quit                                     }\n"
-                      << "{ use  :help                      to toggle help                              }\n"
-                      << "matchmaker (" << matchmaker::count() << ") $  ";
-        else
-            std::cout << "matchmaker (" << matchmaker::count() << ") { enter :help for help } $  ";
+        if (interactive)
+            print_prompt(help);
 
         std::string line;
-        std::getline(std::cin, line);
-        if (std::cin.fail() || std::cin.eof() == 1)
+        std::getline(in, line);
+        if (!interactive && in.fail())
+            return;
+        if (interactive && (in.fail() || in.eof() == 1))
         {
-            std::cin.clear();
-            std::cin.ignore();
-            std::cout << "\ncommand failed! terminal resized?" << std::endl;
-            std::getline(std::cin, line);
+            in.clear();
+            in.ignore();
+            std::cout << "\ncommand failed! terminal resized?\n";
+            std::getline(in, line);
             continue;
         }
         std::vector<std::string> terms;
@@ -68,11 +405,20 @@ void completable_shell()
 
         if (terms.size() == 0 || terms[0].length() == 0)
         {
-            std::cout << std::endl;
+            if (interactive)
+                std::cout << "\n";
             continue;
         }
+        bool const structured = records.get_format() != output_format::text::grab();
+
         if (terms[0][0] == '!')
         {
+            if (structured)
+            {
+                write_completion(records, line.substr(1));
+                continue;
+            }
+
             int completion_start{0};
             int completion_length{0};
             auto start = std::chrono::high_resolution_clock::now();
@@ -82,7 +428,7 @@ void completable_shell()
             std::cout << "completion (" << completion_length << ") :\n";
             for (int i = completion_start; i < completion_start + completion_length; ++i)
                 std::cout << "    --> " << matchmaker::at(i, nullptr) << "\n";
-            std::cout << "\ncompletion done in " << duration.count() << " microseconds" << std::endl;
+            std::cout << "\ncompletion done in " << duration.count() << " microseconds\n";
         }
         else if (terms[0] == ":it")
         {
@@ -92,6 +438,13 @@ void completable_shell()
             int start{0}; try { start = std::stoi(terms[1]); } catch (...) { continue; }
             int count{0}; try { count = std::stoi(terms[2]); } catch (...) { continue; }
 
+            if (structured)
+            {
+                for (int i = std::max(0, start); i < matchmaker::count() && i < start + count; ++i)
+                    write_term(records, i);
+                continue;
+            }
+
             for (int i = start; i < matchmaker::count() && i < start + count; ++i)
             {
                 auto start = std::chrono::high_resolution_clock::now();
@@ -102,18 +455,23 @@ void completable_shell()
                             << std::setw(MAX_INDEX_DIGITS) << matchmaker::as_longest(i) << "] :  '"
                             << word << "' accessed in " << duration.count() << " microseconds\n";
             }
-            std::cout << std::flush;
         }
         else if (terms[0] == ":pos")
         {
             if (terms.size() < 2)
                 continue;
 
+            if (structured)
+            {
+                write_parts_of_speech(records, line.substr(5));
+                continue;
+            }
+
             std::cout << "       [";
             index = matchmaker::lookup(line.substr(5).c_str(), &found);
             if (index == matchmaker::count())
             {
-                std::cout << matchmaker::count() << "], (would be new last word)" << std::endl;
+                std::cout << matchmaker::count() << "], (would be new last word)\n";
                 continue;
             }
             auto start = std::chrono::high_resolution_clock::now();
@@ -135,19 +493,25 @@ void completable_shell()
                 std::cout << "NONE AVAILABLE";
 
             std::cout << "\n       -------> parts_of_speech() time: "
-                        << duration.count() << " microseconds" << std::endl;
+                        << duration.count() << " microseconds\n";
         }
         else if (terms[0] == ":s")
         {
             if (terms.size() < 2)
                 continue;
 
+            if (structured)
+            {
+                write_related_terms(records, "synonyms", line.substr(3), &matchmaker::synonyms);
+                continue;
+            }
+
             std::cout << "       [";
             auto start = std::chrono::high_resolution_clock::now();
             index = matchmaker::lookup(line.substr(3).c_str(), &found);
             if (index == matchmaker::count())
             {
-                std::cout << matchmaker::count() << "], (would be new last word)" << std::endl;
+                std::cout << matchmaker::count() << "], (would be new last word)\n";
                 continue;
             }
             int const * syn_array{nullptr};
@@ -166,19 +530,25 @@ void completable_shell()
             else
                 std::cout << " NONE AVAILABLE";
             std::cout << "\n       -------> lookup + synonym retrieval time: "
-                        << duration.count() << " microseconds" << std::endl;
+                        << duration.count() << " microseconds\n";
         }
         else if (terms[0] == ":a")
         {
             if (terms.size() < 2)
                 continue;
 
+            if (structured)
+            {
+                write_related_terms(records, "antonyms", line.substr(3), &matchmaker::antonyms);
+                continue;
+            }
+
             std::cout << "       [";
             auto start = std::chrono::high_resolution_clock::now();
             index = matchmaker::lookup(line.substr(3).c_str(), &found);
             if (index == matchmaker::count())
             {
-                std::cout << matchmaker::count() << "], (would be new last word)" << std::endl;
+                std::cout << matchmaker::count() << "], (would be new last word)\n";
                 continue;
             }
             int const * ant_array{nullptr};
@@ -197,19 +567,25 @@ void completable_shell()
             else
                 std::cout << " NONE AVAILABLE";
             std::cout << "\n       -------> lookup + antonym retrieval time: "
-                        << duration.count() << " microseconds" << std::endl;
+                        << duration.count() << " microseconds\n";
         }
         else if (terms[0] == ":def")
         {
             if (terms.size() < 2)
                 continue;
 
+            if (structured)
+            {
+                write_related_terms(records, "definition", line.substr(5), &matchmaker::definition);
+                continue;
+            }
+
             std::cout << "       [";
             auto start = std::chrono::high_resolution_clock::now();
             index = matchmaker::lookup(line.substr(5).c_str(), &found);
             if (index == matchmaker::count())
             {
-                std::cout << matchmaker::count() << "], (would be new last word)" << std::endl;
+                std::cout << matchmaker::count() << "], (would be new last word)\n";
                 continue;
             }
             int const * def{nullptr};
@@ -226,7 +602,7 @@ void completable_shell()
             if (def_count == 0)
                 std::cout << " NONE AVAILABLE";
             std::cout << "\n       -------> lookup + definiton retrieval time: "
-                        << duration.count() << " microseconds" << std::endl;
+                        << duration.count() << " microseconds\n";
         }
         else if (terms[0] == ":itl")
         {
@@ -236,18 +612,31 @@ void completable_shell()
             int start{0}; try { start = std::stoi(terms[1]); } catch (...) { continue; }
             int count{0}; try { count = std::stoi(terms[2]); } catch (...) { continue; }
 
+            if (structured)
+            {
+                for (int i = std::max(0, start); i < matchmaker::count() && i < start + count; ++i)
+                    write_term(records, matchmaker::from_longest(i));
+                continue;
+            }
+
             for (int i = start; i < (int) matchmaker::count() && i < start + count; ++i)
             {
                 int word_len{0};
                 char const * word = matchmaker::at(matchmaker::from_longest(i), &word_len);
                 std::cout << "       [" << std::setw(MAX_INDEX_DIGITS) << matchmaker::from_longest(i)
                             << "], length[" << std::setw(MAX_INDEX_DIGITS) << i << "]  "
-                            << word << " has " << word_len << " characters" << std::endl;
+                            << word << " has " << word_len << " characters\n";
             }
         }
         else if (terms[0] == ":len")
         {
-            std::cout << "The following length indexes can be used with ':itl'" << std::endl;
+            if (structured)
+            {
+                write_lengths(records);
+                continue;
+            }
+
+            std::cout << "The following length indexes can be used with ':itl'\n";
 
             int index{0};
             int count{0};
@@ -263,10 +652,10 @@ void completable_shell()
                 if (matchmaker::length_location(l, &index, &count))
                     std::cout << "    " << std::setw(MAX_INDEX_DIGITS) << l
                                 << " letter terms begin at index [" << std::setw(MAX_INDEX_DIGITS)
-                                << index << "] with a count of: " << std::to_string(count) << std::endl;
+                                << index << "] with a count of: " << std::to_string(count) << "\n";
                 else
                     std::cout << "index [" << l << "] out of bounds! expected range: [0.."
-                                << matchmaker::count() << "]" << std::endl;
+                                << matchmaker::count() << "]\n";
             }
         }
         else if (terms[0] == ":e")
@@ -276,6 +665,12 @@ void completable_shell()
 
             int index{0}; try { index = std::stoi(line.substr(3)); } catch (...) { continue; }
 
+            if (structured)
+            {
+                write_embedded(records, index);
+                continue;
+            }
+
             int const * embedded_terms;
             int count{0};
             matchmaker::embedded(index, &embedded_terms, &count);
@@ -288,12 +683,17 @@ void completable_shell()
                 std::cout << "       --> [" << std::setw(MAX_INDEX_DIGITS) << embedded_terms[i] << "], length["
                             << std::setw(MAX_INDEX_DIGITS) << matchmaker::as_longest(embedded_terms[i]) << "] :  '"
                             << matchmaker::at(embedded_terms[i], nullptr) << "'\n";
-            std::cout << std::flush;
         }
         else if (terms[0] == ":books")
         {
+            if (structured)
+            {
+                write_books(records);
+                continue;
+            }
+
             std::cout << "The number of books in the library is: " << matchmaker::book_count()
-                      << std::endl << std::endl;
+                      << "\n\n";
             for (int i = 0; i < matchmaker::book_count(); ++i)
             {
                 std::cout << "    [" << std::to_string(i) << "]\n"
@@ -312,7 +712,7 @@ void completable_shell()
                     std::cout << matchmaker::at(author[t], nullptr);
 
                 std::cout << "\n        chapters: "
-                            << std::to_string(matchmaker::chapter_count(i)) << "\n" << std::endl;
+                            << std::to_string(matchmaker::chapter_count(i)) << "\n\n";
             }
         }
         else if (terms[0] == ":book")
@@ -320,66 +720,26 @@ void completable_shell()
             if (terms.size() < 2)
                 continue;
 
-            int book_index{0}; try { book_index = std::stoi(line.substr(6)); } catch (...) { continue; }
-
-            std::cout << "Reading book [" << terms[1] << "]...\n"
-                      << "\n               title: ";
-            int const * title{nullptr};
-            int title_count{0};
-            matchmaker::book_title(book_index, &title, &title_count);
-            for (int t = 0; t < title_count; ++t)
-                std::cout << matchmaker::at(title[t], nullptr);
-
-            std::cout << "\n              author: ";
-            int const * author{nullptr};
-            int author_count{0};
-            matchmaker::book_author(book_index, &author, &author_count);
-            for (int t = 0; t < author_count; ++t)
-                std::cout << matchmaker::at(author[t], nullptr);
-
-            std::cout << "\n            chapters: "
-                        << std::to_string(matchmaker::chapter_count(book_index)) << "\n" << std::endl;
-
-            for (int ch = 0; ch < matchmaker::chapter_count(book_index); ++ch)
-            {
-                std::cout << "\n***********************************************************************\n";
-                std::cout << "   chapter title: ";
-                int const * ch_title{nullptr};
-                int ch_title_count{0};
-                matchmaker::chapter_title(book_index, ch, &ch_title, &ch_title_count);
-                for (int t = 0; t < ch_title_count; ++t)
-                    std::cout << matchmaker::at(ch_title[t], nullptr);
-
-                std::cout << "\nchapter subtitle: ";
-                int const * ch_subtitle{nullptr};
-                int ch_subtitle_count{0};
-                matchmaker::chapter_subtitle(book_index, ch, &ch_subtitle, &ch_subtitle_count);
-                for (int t = 0; t < ch_subtitle_count; ++t)
-                    std::cout << matchmaker::at(ch_subtitle[t], nullptr);
-                std::cout << "\n-----------------------------------------------------------------------"
-                          << std::endl;
-                for (int p = 0; p < matchmaker::paragraph_count(book_index, ch); ++p)
-                {
-                    for (int w = 0; w < matchmaker::word_count(book_index, ch, p); ++w)
-                    {
-                        int ancestor_count = 0;
-                        int const * ancestors;
-                        int index_within_first_ancestor{-1};
-                        int term = matchmaker::word(book_index,
-                                                    ch,
-                                                    p,
-                                                    w,
-                                                    &ancestors,
-                                                    &ancestor_count,
-                                                    &index_within_first_ancestor,
-                                                    nullptr);
-
-                        std::cout << " " << matchmaker::at(term, nullptr);
-                    }
-                    std::cout << std::endl;
-                }
-                std::cout << "***********************************************************************\n\n\n"
-                          << std::endl;
+            int book_index{0}; try { book_index = std::stoi(terms[1]); } catch (...) { continue; }
+
+            std::ostream & report = structured ? std::cerr : std::cout;
+            report << "Reading book [" << terms[1] << "]...\n";
+            if (terms.size() > 2)
+            {
+                int const fd = open(terms[2].c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (fd == -1 || !book_render::write_book(book_index, fd))
+                    write_error(records, "failed to write " + terms[2] + ": " + std::strerror(errno));
+                else
+                    report << "wrote " << terms[2] << "\n";
+
+                if (fd != -1)
+                    close(fd);
+            }
+            else
+            {
+                std::cout << std::flush;
+                if (!book_render::write_book(book_index, STDOUT_FILENO))
+                    write_error(records, std::string{"failed to write book: "} + std::strerror(errno));
             }
         }
         else if (terms[0] == ":p")
@@ -406,6 +766,21 @@ void completable_shell()
                            nullptr
                        );
 
+            if (structured)
+            {
+                records.begin("parent");
+                records.int_field("book", bk);
+                records.int_field("chapter", ch);
+                records.int_field("paragraph", par);
+                records.int_field("word_index", wrd);
+                records.int_field("index", term);
+                records.string_field("word", matchmaker::at(term, nullptr));
+                records.term_list("ancestors", ancestors, ancestor_count);
+                records.int_field("index_within_parent", index_within_first_ancestor);
+                records.end();
+                continue;
+            }
+
             std::cout << "\n"
                       << "\n         given term: " << term
                       << "\n        term as str: " << matchmaker::at(term, nullptr)
@@ -419,50 +794,323 @@ void completable_shell()
             for (int i = 0; i < ancestor_count; ++i)
                 std::cout << " " << matchmaker::at(ancestors[i], nullptr);
 
-            std::cout << "\nindex within parent: " << index_within_first_ancestor << std::endl;
+            std::cout << "\nindex within parent: " << index_within_first_ancestor << "\n";
         }
         else if (terms[0] == ":loc")
         {
             if (terms.size() < 2)
                 continue;
 
-            int search_word{0}; try { search_word = std::stoi(line.substr(5)); } catch (...) { continue; }
+            std::vector<int> search_words = parse_loc_terms(records, terms);
+            auto const found = concordance::locate(search_words, kwic_width);
 
-            int const * book_indexes{nullptr};
-            int const * chapter_indexes{nullptr};
-            int const * paragraph_indexes{nullptr};
-            int const * word_indexes{nullptr};
-            int count{0};
-            matchmaker::locations(search_word,
-                                  &book_indexes,
-                                  &chapter_indexes,
-                                  &paragraph_indexes,
-                                  &word_indexes,
-                                  &count);
-            std::cout << matchmaker::at(search_word, nullptr) << "\n";
-            for (int i = 0; i < count; ++i)
+            if (structured)
             {
-                std::cout << "  ----> ("
-                          << std::to_string(book_indexes[i]) << ", "
-                          << std::to_string(chapter_indexes[i]) << ", "
-                          << std::to_string(paragraph_indexes[i]) << ", "
-                          << std::to_string(word_indexes[i]) << ")" << std::endl;
+                for (size_t i = 0; i < search_words.size(); ++i)
+                    write_locations(records, search_words[i], found[i]);
+                continue;
+            }
+
+            for (size_t i = 0; i < search_words.size(); ++i)
+            {
+                std::cout << matchmaker::at(search_words[i], nullptr) << "\n";
+                for (auto const & o : found[i])
+                {
+                    std::cout << "  ----> ("
+                              << std::to_string(o.book) << ", "
+                              << std::to_string(o.chapter) << ", "
+                              << std::to_string(o.paragraph) << ", "
+                              << std::to_string(o.word) << ")";
+                    if (kwic_width > 0)
+                        std::cout << "  " << std::setw(kwic_width) << o.left
+                                  << " [" << o.keyword << "] " << o.right;
+                    std::cout << "\n";
+                }
+                if (found[i].empty())
+                    std::cout << "  ----> NONE!\n";
             }
-            if (count == 0)
-                std::cout << "  ----> NONE!" << std::endl;
+        }
+        else if (terms[0] == ":kwic")
+        {
+            if (terms.size() > 1)
+            {
+                int width{0}; try { width = std::stoi(terms[1]); } catch (...) { continue; }
+                if (width < 0)
+                    continue;
+
+                kwic_width = width;
+            }
+
+            if (structured)
+            {
+                records.begin("kwic");
+                records.int_field("width", kwic_width);
+                records.end();
+                continue;
+            }
+
+            std::cout << "kwic width: " << kwic_width << "\n";
+        }
+        else if (terms[0] == ":stats")
+        {
+            if (terms.size() > 1)
+            {
+                if (terms[1] == "on" || terms[1] == "off")
+                {
+                    auto const e = terms[1] == "on" ? Enabledness::Enabled::grab() : Enabledness::Disabled::grab();
+                    EnablednessSetting::Shim_spc_Stats::grab().set_enabledness(e);
+                    EnablednessSetting::Frame_spc_Stats::grab().set_enabledness(e);
+
+                    // without the curses tabs nobody observes the settings
+                    if (!interactive)
+                        matchmaker::set_stats_enabled(terms[1] == "on");
+                }
+                else if (terms[1] == "reset")
+                {
+                    matchmaker::reset_stats();
+                    frame::reset_stats();
+                    AbstractListWindow::reset_cache_stats();
+                    thread_pool::reset_stats();
+                    concordance::reset_stats();
+                }
+                else
+                {
+                    continue;
+                }
+            }
+
+            // a report for people, kept out of the records
+            std::ostream & report = structured ? std::cerr : std::cout;
+            report << "shim stats: " << (matchmaker::stats_enabled() ? "enabled" : "disabled")
+                      << "    frame stats: " << (frame::stats_enabled() ? "enabled" : "disabled") << "\n\n"
+                      << std::left << std::setw(22) << "function" << std::right
+                      << std::setw(12) << "calls"
+                      << std::setw(10) << "mean ns"
+                      << std::setw(10) << "p50 ns"
+                      << std::setw(10) << "p99 ns"
+                      << std::setw(10) << "p999 ns" << "\n";
+
+            for (int i = 0; i < matchmaker::stats_count(); ++i)
+            {
+                matchmaker::function_stats fs;
+                matchmaker::collect_stats(i, &fs);
+                if (fs.calls == 0)
+                    continue;
+
+                report << std::left << std::setw(22) << fs.name << std::right
+                          << std::setw(12) << fs.calls
+                          << std::setw(10) << fs.total_ns / fs.calls
+                          << std::setw(10) << matchmaker::stats_percentile(fs, 0.5)
+                          << std::setw(10) << matchmaker::stats_percentile(fs, 0.99)
+                          << std::setw(10) << matchmaker::stats_percentile(fs, 0.999) << "\n";
+            }
+
+            frame::frame_stats frs;
+            frame::collect_stats(&frs);
+            report << "\nframes: " << frs.frames
+                      << "    bytes/frame  last: " << frs.last_bytes
+                      << "  mean: " << (frs.frames == 0 ? 0 : frs.bytes / frs.frames)
+                      << "  max: " << frs.max_bytes << "\n"
+                      << "windows drawn: " << frs.windows_drawn
+                      << "    already drawn in frame (skipped): " << frs.draws_skipped << "\n";
+
+            report << "last frame drew:";
+            for (auto const & [window, reason] : frame::last_frame_draws())
+                report << "  " << window << " (" << reason << ")";
+            report << "\n";
+
+            AbstractListWindow::cache_stats cas;
+            AbstractListWindow::collect_cache_stats(&cas);
+            report << "word caches  hits: " << cas.hits << "  misses: " << cas.misses << "\n";
+
+            concordance::cache_stats ccs;
+            concordance::collect_stats(&ccs);
+            report << "paragraph cache  paragraphs: " << ccs.paragraphs << "  bytes: " << ccs.bytes
+                      << "  hits: " << ccs.hits << "  misses: " << ccs.misses
+                      << "  evicted: " << ccs.evictions << "\n";
+
+            report << "\nthread pool: " << thread_pool::size() << " threads\n";
+            for (int l = 0; l < thread_pool::LANE_COUNT; ++l)
+            {
+                thread_pool::lane_stats ls;
+                thread_pool::collect_stats((thread_pool::lane) l, &ls);
+                report << "  " << std::left << std::setw(12) << thread_pool::lane_name((thread_pool::lane) l)
+                          << std::right
+                          << "  queued: " << ls.depth << " (max " << ls.max_depth << ")"
+                          << "  submitted: " << ls.submitted
+                          << "  completed: " << ls.completed
+                          << "  stolen: " << ls.stolen << "\n";
+            }
+
+            report << "\nrecent long tasks:\n";
+            for (auto const & t : recent_tasks())
+            {
+                report << "  " << std::left << std::setw(16) << t.name << std::right
+                          << std::setw(12) << t.items << " items"
+                          << std::setw(10) << t.elapsed_ms << " ms"
+                          << std::setw(12) << (t.elapsed_ms == 0 ? 0 : t.items * 1000 / t.elapsed_ms) << " /s"
+                          << (t.completed ? "" : "  (cancelled)") << "\n";
+            }
+        }
+        else if (terms[0] == ":mem")
+        {
+            if (terms.size() > 1)
+            {
+                if (terms[1] != "reset")
+                    continue;
+
+                memory_accounting::reset_stats();
+            }
+
+            if (structured)
+            {
+                write_memory(records);
+                continue;
+            }
+
+            std::cout << std::left << std::setw(22) << "component" << std::right
+                      << std::setw(14) << "bytes"
+                      << std::setw(14) << "peak bytes"
+                      << std::setw(10) << "accounts" << "\n";
+
+            uint64_t total{0};
+            for (int c = 0; c < memory_accounting::COMPONENT_COUNT; ++c)
+            {
+                memory_accounting::component_stats cs;
+                memory_accounting::collect_stats((memory_accounting::component) c, &cs);
+                total += cs.bytes;
+
+                std::cout << std::left << std::setw(22)
+                          << memory_accounting::component_name((memory_accounting::component) c) << std::right
+                          << std::setw(14) << cs.bytes
+                          << std::setw(14) << cs.peak_bytes
+                          << std::setw(10) << cs.accounts << "\n";
+            }
+            std::cout << std::left << std::setw(22) << "total" << std::right << std::setw(14) << total << "\n\n";
+
+            memory_accounting::mapping_stats library;
+            memory_accounting::mapping_stats process;
+            if (!memory_accounting::collect_file_mappings(matchmaker::library_address(), &library)
+                || !memory_accounting::collect_process_mappings(&process))
+            {
+                std::cout << "failed to read /proc/self/smaps\n";
+                continue;
+            }
+
+            std::cout << std::left << std::setw(22) << "mappings" << std::right
+                      << std::setw(10) << "count"
+                      << std::setw(14) << "size"
+                      << std::setw(14) << "rss"
+                      << std::setw(14) << "pss"
+                      << std::setw(14) << "private" << "\n";
+            for (auto const & [name, ms] : {std::pair{"library", &library}, std::pair{"process", &process}})
+                std::cout << std::left << std::setw(22) << name << std::right
+                          << std::setw(10) << ms->mappings
+                          << std::setw(14) << ms->size
+                          << std::setw(14) << ms->rss
+                          << std::setw(14) << ms->pss
+                          << std::setw(14) << ms->private_bytes << "\n";
+
+            if (!library.path.empty())
+                std::cout << "library: " << library.path << "\n";
+        }
+        else if (terms[0] == ":bench")
+        {
+            int iterations{BENCH_DEFAULT_ITERATIONS};
+            if (terms.size() > 1)
+            {
+                try { iterations = std::stoi(terms[1]); } catch (...) { continue; }
+                if (iterations <= 0)
+                    continue;
+            }
+
+            std::vector<int> sample;
+            for (size_t i = 2; i < terms.size(); ++i)
+            {
+                bool word_found{false};
+                int const word_index = matchmaker::lookup(terms[i].c_str(), &word_found);
+                if (word_found)
+                    sample.push_back(word_index);
+                else
+                    write_error(records, "skipping unknown word '" + terms[i] + "'");
+            }
+            if (terms.size() <= 2)
+                sample = bench::random_sample(BENCH_SAMPLE_SIZE, BENCH_SEED);
+
+            if (sample.empty())
+                continue;
+
+            std::ostream & report = structured ? std::cerr : std::cout;
+            report << "benchmarking " << iterations << " iterations over " << sample.size() << " words";
+            if (matchmaker::stats_enabled())
+                report << " (shim stats are enabled and add to the timings)";
+            report << "\n\n"
+                      << std::left << std::setw(22) << "workload" << std::right
+                      << std::setw(12) << "ops"
+                      << std::setw(10) << "ns/op"
+                      << std::setw(10) << "p50 ns"
+                      << std::setw(10) << "p99 ns"
+                      << std::setw(10) << "p999 ns"
+                      << std::setw(14) << "ops/s" << "\n";
+
+            for (auto const & r : bench::run_dictionary_workloads(sample, iterations))
+                report << std::left << std::setw(22) << r.workload << std::right
+                          << std::setw(12) << r.ops
+                          << std::setw(10) << std::fixed << std::setprecision(1) << r.ns_per_op
+                          << std::setw(10) << r.p50_ns
+                          << std::setw(10) << r.p99_ns
+                          << std::setw(10) << r.p999_ns
+                          << std::setw(14) << std::setprecision(0) << r.ops_per_s << "\n"
+                          << std::defaultfloat << std::setprecision(6);
         }
         else if (terms[0] == ":curses")
         {
-            break;
+            if (interactive)
+                break;
         }
         else if (terms[0] == ":q")
         {
+            if (!interactive)
+                return;
+
             exit(EXIT_SUCCESS);
         }
         else if (terms[0] == ":help")
         {
             help = !help;
         }
+        else if (terms[0] == ":fmt")
+        {
+            if (terms.size() > 1)
+            {
+                output_format::Type format;
+                for (auto f : output_format::variants())
+                    if (f.as_string() == terms[1])
+                        format = f;
+
+                if (format.is_nil())
+                    continue;
+
+                records.set_format(format);
+            }
+
+            if (records.get_format() != output_format::text::grab())
+            {
+                if (terms.size() == 1)
+                {
+                    records.begin("format");
+                    records.string_field("format", records.get_format().as_string());
+                    records.end();
+                }
+                continue;
+            }
+
+            std::cout << "output format: " << records.get_format() << "\n";
+        }
+        else if (structured)
+        {
+            write_lookup(records, line);
+        }
         else
         {
             std::cout << "       [";
@@ -481,7 +1129,19 @@ void completable_shell()
             {
                 std::cout << matchmaker::count() << "], (would be new last word)";
             }
-            std::cout << "       lookup time: " << duration.count() << " microseconds" << std::endl;
+            std::cout << "       lookup time: " << duration.count() << " microseconds\n";
         }
     }
 }
+
+
+void completable_shell()
+{
+    run_shell(std::cin, true);
+}
+
+
+void completable_shell_batch(std::istream & in)
+{
+    run_shell(in, false);
+}
@@ -1,6 +1,17 @@
 #pragma once
 
+#include <istream>
+
 /**
  * completable_shell() implements a simple, non-ncurses command-line app using the matchmaker library
  */
 void completable_shell();
+
+/**
+ * Run the shell's commands read from a stream without prompts, help or ncurses. Output is written to
+ * std::cout and not flushed per command, so callers should buffer it. Ends at the end of the stream or
+ * on :q, and ignores :curses
+ *
+ * @param[in] in The commands to run, one per line
+ */
+void completable_shell_batch(std::istream & in);
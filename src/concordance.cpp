@@ -0,0 +1,237 @@
+#include "concordance.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "book_render.h"
+#include "matchmaker.h"
+#include "memory_accounting.h"
+#include "thread_pool.h"
+
+
+
+namespace concordance
+{
+    struct paragraph_text
+    {
+        std::string text;
+        std::vector<int> word_offsets;
+    };
+
+    // the cache is split so that threads rendering different paragraphs rarely wait on each other
+    static int const SHARD_COUNT{16};
+
+    // bytes of rendered paragraphs a shard keeps, least recently used paragraphs are evicted beyond that
+    static uint64_t const SHARD_BUDGET{(16 << 20) / SHARD_COUNT};
+
+    // number of words located by a single pool task
+    static int const TERMS_PER_TASK{8};
+
+    struct cached
+    {
+        std::shared_ptr<paragraph_text const> paragraph;
+        uint64_t bytes;
+        std::list<uint64_t>::iterator used;
+    };
+
+    struct shard
+    {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, cached> paragraphs;
+        std::list<uint64_t> recently_used;  // keys, most recently used first
+        memory_accounting::account memory{memory_accounting::PARAGRAPH_CACHE};
+    };
+
+    static shard shards[SHARD_COUNT];
+
+    // paragraphs are only valid for the library they were rendered from
+    static uint64_t cached_generation{0};
+
+    static std::atomic<uint64_t> hits{0};
+    static std::atomic<uint64_t> misses{0};
+    static std::atomic<uint64_t> evictions{0};
+
+
+    static uint64_t paragraph_key(int book, int chapter, int paragraph)
+    {
+        return ((uint64_t) book << 42) | ((uint64_t) chapter << 21) | (uint64_t) paragraph;
+    }
+
+
+    static std::shared_ptr<paragraph_text const> cached_paragraph(int book, int chapter, int paragraph)
+    {
+        uint64_t const key = paragraph_key(book, chapter, paragraph);
+        shard & s = shards[key % SHARD_COUNT];
+        {
+            std::lock_guard<std::mutex> lock{s.mutex};
+            auto it = s.paragraphs.find(key);
+            if (it != s.paragraphs.end())
+            {
+                ++hits;
+                s.recently_used.splice(s.recently_used.begin(), s.recently_used, it->second.used);
+                return it->second.paragraph;
+            }
+        }
+        ++misses;
+
+        // rendered without holding the shard, should another thread render it meanwhile then its copy wins
+        auto rendered = std::make_shared<paragraph_text>();
+        book_render::render_paragraph(book, chapter, paragraph, rendered->text, &rendered->word_offsets);
+
+        uint64_t const bytes = sizeof(paragraph_text)
+                               + memory_accounting::heap_bytes(rendered->text)
+                               + memory_accounting::heap_bytes(rendered->word_offsets);
+
+        std::lock_guard<std::mutex> lock{s.mutex};
+        auto const [it, inserted] = s.paragraphs.try_emplace(key, cached{std::move(rendered), bytes, {}});
+        if (!inserted)
+        {
+            s.recently_used.splice(s.recently_used.begin(), s.recently_used, it->second.used);
+            return it->second.paragraph;
+        }
+        s.recently_used.push_front(key);
+        it->second.used = s.recently_used.begin();
+        uint64_t held = s.memory.get() + bytes;
+
+        // evicted paragraphs stay alive while snippets are still being cut from them
+        std::shared_ptr<paragraph_text const> kept = it->second.paragraph;
+        while (held > SHARD_BUDGET && s.recently_used.size() > 1)
+        {
+            auto const oldest = s.paragraphs.find(s.recently_used.back());
+            held -= oldest->second.bytes;
+            s.paragraphs.erase(oldest);
+            s.recently_used.pop_back();
+            ++evictions;
+        }
+        s.memory.set(held);
+
+        return kept;
+    }
+
+
+    static bool is_utf8_continuation(char ch)
+    {
+        return (ch & 0xc0) == 0x80;
+    }
+
+
+    static void cut_snippet(occurrence & o, int width)
+    {
+        auto const p = cached_paragraph(o.book, o.chapter, o.paragraph);
+        if (o.word < 0 || o.word >= (int) p->word_offsets.size())
+            return;
+
+        std::string const & text = p->text;
+        int const start = p->word_offsets[o.word];
+        int const end = o.word + 1 < (int) p->word_offsets.size() ? p->word_offsets[o.word + 1] - 1
+                                                                   : (int) text.size();
+
+        // the space preceding every word is not part of the context
+        int const left_end = std::max(0, start - 1);
+        int left_start = std::max(0, left_end - width);
+        int const right_start = std::min((int) text.size(), end + 1);
+        int right_end = std::min((int) text.size(), right_start + width);
+
+        // never cut a character in half, and drop spaces left at the edges by the cut
+        while (left_start < left_end && (is_utf8_continuation(text[left_start]) || text[left_start] == ' '))
+            ++left_start;
+        while (right_end > right_start && right_end < (int) text.size() && is_utf8_continuation(text[right_end]))
+            --right_end;
+        while (right_end > right_start && text[right_end - 1] == ' ')
+            --right_end;
+
+        o.left.assign(text, left_start, left_end - left_start);
+        o.keyword.assign(text, start, end - start);
+        o.right.assign(text, right_start, right_end - right_start);
+    }
+
+
+    static void locate_term(int term, int width, std::vector<occurrence> & found)
+    {
+        int const * book_indexes{nullptr};
+        int const * chapter_indexes{nullptr};
+        int const * paragraph_indexes{nullptr};
+        int const * word_indexes{nullptr};
+        int count{0};
+        matchmaker::locations(term, &book_indexes, &chapter_indexes, &paragraph_indexes, &word_indexes, &count);
+
+        found.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            occurrence & o = found[i];
+            o.book = book_indexes[i];
+            o.chapter = chapter_indexes[i];
+            o.paragraph = paragraph_indexes[i];
+            o.word = word_indexes[i];
+
+            if (width > 0)
+                cut_snippet(o, width);
+        }
+    }
+
+
+    std::vector<std::vector<occurrence>> locate(std::vector<int> const & terms, int width)
+    {
+        if (matchmaker::library_generation() != cached_generation)
+        {
+            for (auto & s : shards)
+            {
+                std::lock_guard<std::mutex> lock{s.mutex};
+                s.paragraphs.clear();
+                s.recently_used.clear();
+                s.memory.set(0);
+            }
+            cached_generation = matchmaker::library_generation();
+        }
+
+        std::vector<std::vector<occurrence>> results(terms.size());
+        std::vector<std::future<void>> located;
+        for (size_t first = 0; first < terms.size(); first += TERMS_PER_TASK)
+        {
+            size_t const last = std::min(terms.size(), first + TERMS_PER_TASK);
+            located.push_back(thread_pool::submit(
+                thread_pool::INTERACTIVE,
+                [&terms, &results, first, last, width]()
+                {
+                    auto library_lock = matchmaker::lock_library();
+                    for (size_t i = first; i < last; ++i)
+                        locate_term(terms[i], width, results[i]);
+                }
+            ));
+        }
+
+        for (auto & f : located)
+            thread_pool::get(f);
+
+        return results;
+    }
+
+
+    void collect_stats(cache_stats * cs)
+    {
+        cs->paragraphs = 0;
+        cs->bytes = 0;
+        for (auto & s : shards)
+        {
+            std::lock_guard<std::mutex> lock{s.mutex};
+            cs->paragraphs += s.paragraphs.size();
+            cs->bytes += s.memory.get();
+        }
+        cs->hits = hits;
+        cs->misses = misses;
+        cs->evictions = evictions;
+    }
+
+
+    void reset_stats()
+    {
+        hits = 0;
+        misses = 0;
+        evictions = 0;
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+    Finds where words occur in the library's books and cuts keyword-in-context (KWIC) snippets out of
+    the surrounding paragraphs. Words are located in parallel on the thread pool, and rendered paragraphs
+    are cached so that paragraphs shared by many occurrences are only rendered once. The cache is bounded
+    in bytes and evicts the least recently used paragraphs.
+*/
+
+namespace concordance
+{
+    struct occurrence
+    {
+        int book;
+        int chapter;
+        int paragraph;
+        int word;
+
+        // context, empty if no snippets were requested
+        std::string left;
+        std::string keyword;
+        std::string right;
+    };
+
+    /**
+     * Locate every occurrence of the given words. Must be called from the thread that sets the library
+     *
+     * @param[in] terms Indexes of the words to locate
+     * @param[in] width Maximum number of characters of context on each side, 0 for no snippets
+     * @returns For each of the given terms, its occurrences in book order
+     */
+    std::vector<std::vector<occurrence>> locate(std::vector<int> const & terms, int width);
+
+    struct cache_stats
+    {
+        uint64_t paragraphs;
+        uint64_t bytes;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+    };
+
+    /**
+     * @param[out] cs The paragraph cache's size and hits, misses and evictions since the last reset_stats()
+     */
+    void collect_stats(cache_stats * cs);
+
+    /**
+     * Forget hits, misses and evictions recorded so far
+     */
+    void reset_stats();
+}
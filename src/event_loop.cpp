@@ -0,0 +1,107 @@
+#include "event_loop.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+
+
+namespace event_loop
+{
+    static int wakeup_fd{-1};
+    static int signal_fd{-1};
+    static int timer_fd{-1};
+
+
+    // read and discard whatever a nonblocking fd has pending
+    static void drain(int fd, void * buf, size_t len)
+    {
+        while (read(fd, buf, len) > 0)
+            ;
+    }
+
+
+    void init()
+    {
+        wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        sigset_t mask;
+        sigemptyset(&mask);
+        sigaddset(&mask, SIGWINCH);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+        signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    }
+
+
+    void wake()
+    {
+        uint64_t const one{1};
+        ssize_t const written = write(wakeup_fd, &one, sizeof(one));
+        (void) written; // a full counter already guarantees a wakeup
+    }
+
+
+    void set_timer(int interval_ms)
+    {
+        itimerspec spec{};
+        spec.it_interval.tv_sec = interval_ms / 1000;
+        spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+        spec.it_value = spec.it_interval;
+        timerfd_settime(timer_fd, 0, &spec, nullptr);
+    }
+
+
+    unsigned wait(int timeout_ms, unsigned wanted)
+    {
+        // a negative fd is ignored by poll()
+        pollfd fds[4] = {
+            {(wanted & INPUT) ? STDIN_FILENO : -1, POLLIN, 0},
+            {(wanted & WAKEUP) ? wakeup_fd : -1, POLLIN, 0},
+            {(wanted & RESIZE) ? signal_fd : -1, POLLIN, 0},
+            {(wanted & TIMER) ? timer_fd : -1, POLLIN, 0},
+        };
+
+        int ready = poll(fds, 4, timeout_ms);
+        while (ready < 0 && errno == EINTR)
+            ready = poll(fds, 4, timeout_ms);
+
+        if (ready <= 0)
+            return 0;
+
+        unsigned events{0};
+
+        if (fds[0].revents != 0)
+            events |= INPUT;
+
+        if (fds[1].revents != 0)
+        {
+            uint64_t count;
+            drain(wakeup_fd, &count, sizeof(count));
+            events |= WAKEUP;
+        }
+
+        if (fds[2].revents != 0)
+        {
+            signalfd_siginfo info;
+            drain(signal_fd, &info, sizeof(info));
+            events |= RESIZE;
+        }
+
+        if (fds[3].revents != 0)
+        {
+            uint64_t expirations;
+            drain(timer_fd, &expirations, sizeof(expirations));
+            events |= TIMER;
+        }
+
+        return events;
+    }
+}
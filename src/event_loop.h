@@ -0,0 +1,46 @@
+#pragma once
+
+
+/*
+    The main loop waits here for anything that should lead to a redraw: keyboard input, results from
+    background threads, terminal resizes and timers. Only the main thread waits, so all ncurses calls
+    stay on the main thread while other threads merely wake() it.
+*/
+
+namespace event_loop
+{
+    // events returned by wait(), combined with bitwise or
+    static unsigned const INPUT{1};
+    static unsigned const WAKEUP{2};
+    static unsigned const RESIZE{4};
+    static unsigned const TIMER{8};
+    static unsigned const ALL{INPUT | WAKEUP | RESIZE | TIMER};
+
+    /**
+     * Create the event file descriptors and block SIGWINCH so that it is only seen by wait().
+     * Must be called before any thread is started since signal masks are inherited
+     */
+    void init();
+
+    /**
+     * Wake the main thread from wait() with a WAKEUP event. Safe to call from any thread
+     */
+    void wake();
+
+    /**
+     * Arm the timer to produce a TIMER event every interval_ms milliseconds
+     *
+     * @param[in] interval_ms The timer's period, or 0 to disarm the timer
+     */
+    void set_timer(int interval_ms);
+
+    /**
+     * Block until at least one of the given events occurs. Pending wakeups, signals and timer expirations
+     * are consumed, while pending input is left to be read with wgetch(). Events not asked for stay pending
+     *
+     * @param[in] timeout_ms Milliseconds to wait at most, or -1 to wait indefinitely
+     * @param[in] events The events to wait for
+     * @returns The events that occurred, or 0 if the timeout expired
+     */
+    unsigned wait(int timeout_ms = -1, unsigned events = ALL);
+}
@@ -32,14 +32,27 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "exec_long_task_with_busy_animation.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <iostream>
-#include <thread>
+#include <string>
+#include <vector>
 
 #include <ncurses.h>
 
 #include "AbstractWindow.h"
 #include "Settings.h"
+#include "event_loop.h"
+#include "frame.h"
+#include "key_codes.h"
+#include "thread_pool.h"
+
+
+
+// time each animation frame is shown, also the progress refresh period
+static int const ANIMATION_FRAME_MS{125};
 
 
 
@@ -740,60 +753,208 @@ MATCHABLE_VARIANT_PROPERTY_VALUE(Animation, esc_Default, content, &simple_conten
 MATCHABLE_VARIANT_PROPERTY_VALUE(Animation, esc_Cheers_spc_To_spc_107, content, &one0seven)
 
 
-void exec_long_task_with_busy_animation(std::function<void()> task, AbstractWindow & win)
+namespace
+{
+    // number of records kept for recent_tasks()
+    int const TASK_RECORD_CAPACITY{8};
+
+    std::vector<task_record> task_records;
+
+    void print_centered(Surface & s, int y, int width, std::string const & text)
+    {
+        int const row_width = width - 2; // 2 for borders (left, right)
+        int const len = std::min((int) text.length(), row_width);
+        int const indent = (row_width - len) / 2;
+
+        s.fill(y, 1, ' ', row_width);
+        s.put_string(y, 1 + indent, std::string_view{text}.substr(0, len));
+    }
+
+    std::string progress_bar(uint64_t done, uint64_t total, int width)
+    {
+        if (done > total)
+            done = total;
+
+        int const filled = (int) (width * done / total);
+        return "[" + std::string(filled, '#') + std::string(width - filled, '.') + "] "
+                   + std::to_string(100 * done / total) + "%";
+    }
+
+    // done items, throughput and, if the total is known, the time left
+    std::string progress_status(TaskProgress const & progress, std::chrono::milliseconds elapsed)
+    {
+        uint64_t const done = progress.get_done();
+        uint64_t const total = progress.get_total();
+        uint64_t const ms = (uint64_t) elapsed.count();
+
+        if (progress.cancelled())
+            return "cancelling...";
+
+        std::string status = std::to_string(done);
+        if (total > 0)
+            status += " / " + std::to_string(total);
+
+        if (ms > 0)
+            status += "    " + std::to_string(done * 1000 / ms) + "/s";
+
+        if (total > 0 && done > 0 && done < total)
+            status += "    ETA " + std::to_string((total - done) * ms / done / 1000 + 1) + "s";
+        else
+            status += "    " + std::to_string(ms / 1000) + "s";
+
+        return status;
+    }
+
+    /**
+     * Take the keys typed while the task runs. A lone Esc requests cancellation, any other key is kept
+     * to be handed back to the main loop with ungetch()
+     */
+    void read_task_keys(WINDOW * w, TaskProgress & progress, std::vector<int> & kept)
+    {
+        nodelay(w, true);
+        for (int ch = wgetch(w); ch != ERR; ch = wgetch(w))
+        {
+            if (ch != ESC)
+            {
+                kept.push_back(ch);
+                continue;
+            }
+
+            // escape sequence (alt + key) is kept, a lone escape cancels
+            int const next = wgetch(w);
+            if (next == ERR)
+            {
+                progress.cancel();
+                break;
+            }
+
+            kept.push_back(ch);
+            kept.push_back(next);
+        }
+        nodelay(w, false);
+    }
+}
+
+
+bool exec_long_task(std::string const & name, std::function<bool (TaskProgress &)> task, AbstractWindow & win)
 {
     animation_content content = AnimationSetting::Busy_spc_Animation::grab().as_animation().as_content();
     if (nullptr == content)
     {
-        std::cerr << "exec_long_task_with_busy_animation() --> animation content null for "
+        std::cerr << "exec_long_task() --> animation content null for "
                   << AnimationSetting::Busy_spc_Animation::grab().as_animation() << std::endl;
-        return;
+        return false;
     }
-    int busy_index = 0;
-    bool finished = false;
-    auto start = std::chrono::high_resolution_clock::now();
 
-    // clear old window content
-    for (int i = 1; i < win.get_height() - 1; ++i)
-        for (int j = 1; j < win.get_width() - 1; ++j)
-            mvwaddch(win.get_WINDOW(), i, j, ' ');
+    // without a surface there is nothing to draw on, without a WINDOW there are no keys to read
+    Surface * s = win.get_surface();
+    WINDOW * w = win.get_WINDOW();
 
-    std::thread animation_thread{
+    // the task runs on a pool thread while this (the only drawing) thread shows its progress
+    TaskProgress progress;
+    std::atomic<bool> finished{false};
+    auto result = thread_pool::submit(
+        thread_pool::INTERACTIVE,
         [&]()
         {
-            while (!finished)
+            bool const completed = task(progress);
+            finished.store(true, std::memory_order_release);
+            event_loop::wake();
+            return completed;
+        }
+    );
+
+    // clear old window content
+    if (nullptr != s)
+        for (int i = 1; i < win.get_height() - 1; ++i)
+            s->fill(i, 1, ' ', win.get_width() - 2);
+
+    // decode escape sequences so that arrow keys and such are not taken for Esc
+    bool const had_keypad = nullptr != w && is_keypad(w);
+    if (nullptr != w)
+        keypad(w, true);
+    std::vector<int> kept_keys;
+
+    auto const start = std::chrono::steady_clock::now();
+    int drawn_index = -1;
+    std::string drawn_status;
+    event_loop::set_timer(ANIMATION_FRAME_MS);
+
+    while (!finished.load(std::memory_order_acquire))
+    {
+        // what is shown follows elapsed time, regardless of how many timer expirations were seen
+        auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start
+        );
+        uint64_t const total = progress.get_total();
+        int const busy_index = total > 0 ? -2 : (int) ((elapsed.count() / ANIMATION_FRAME_MS) % content->size());
+        std::string const status = progress_status(progress, elapsed);
+
+        if (nullptr != s && (busy_index != drawn_index || status != drawn_status))
+        {
+            int const height = win.get_height();
+            int const width = win.get_width();
+
+            if (total > 0)
             {
-                auto stop = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-                if (duration.count() > 124)
-                {
-                    int x_margin = win.get_width() / 2 - (*content)[busy_index][1].length() / 2;
-                    int y_margin = win.get_height() / 2 - (*content)[busy_index].size() / 2;
-                    --y_margin;
-
-                    for (int line = 0; line < (int) (*content)[busy_index].size(); ++line)
-                        mvwprintw(
-                            win.get_WINDOW(),
-                            y_margin + line,
-                            x_margin,
-                            "%s", (*content)[busy_index][line].c_str()
-                        );
-
-                    ++busy_index;
-                    if (busy_index >= (int) content->size())
-                        busy_index = 0;
-
-                    wrefresh(win.get_WINDOW());
-
-                    start = std::chrono::high_resolution_clock::now();
-                }
-
-                std::this_thread::sleep_for(std::chrono::microseconds(17));
+                int const bar_width = std::max(10, std::min(50, width - 12));
+                print_centered(*s, height / 2 - 1, width, progress_bar(progress.get_done(), total, bar_width));
             }
+            else if (busy_index != drawn_index)
+            {
+                int x_margin = width / 2 - (*content)[busy_index][1].length() / 2;
+                int y_margin = height / 2 - (*content)[busy_index].size() / 2;
+                --y_margin;
+
+                for (int line = 0; line < (int) (*content)[busy_index].size(); ++line)
+                    s->put_string(y_margin + line, x_margin, (*content)[busy_index][line]);
+            }
+
+            print_centered(*s, height - 3, width, status);
+            print_centered(*s, height - 2, width, "Esc: cancel");
+
+            s->stage();
+            frame::flush();
+            drawn_index = busy_index;
+            drawn_status = status;
         }
-    };
 
-    task();
-    finished = true;
-    animation_thread.join();
+        // resizes stay pending until the task is done
+        unsigned const input = nullptr == w ? 0 : event_loop::INPUT;
+        unsigned const events = event_loop::wait(-1, input | event_loop::WAKEUP | event_loop::TIMER);
+        if (events & input)
+            read_task_keys(w, progress, kept_keys);
+    }
+
+    event_loop::set_timer(0);
+    bool const completed = result.get();
+
+    if (nullptr != w)
+        keypad(w, had_keypad);
+
+    // hand other keys back to the main loop, ungetch() pushes onto a stack
+    for (auto it = kept_keys.rbegin(); it != kept_keys.rend(); ++it)
+        ungetch(*it);
+    if (kept_keys.size() > 0)
+        event_loop::wake();
+
+    task_records.push_back({
+        name,
+        progress.get_done(),
+        progress.get_total(),
+        (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start
+        ).count(),
+        completed
+    });
+    if ((int) task_records.size() > TASK_RECORD_CAPACITY)
+        task_records.erase(task_records.begin());
+
+    return completed;
+}
+
+
+std::vector<task_record> const & recent_tasks()
+{
+    return task_records;
 }
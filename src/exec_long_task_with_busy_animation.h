@@ -32,11 +32,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 
+#include <cstdint>
 #include <functional>
+#include <string>
+#include <vector>
 
 #include <matchable/matchable.h>
 
 #include "Settings.h"
+#include "TaskProgress.h"
 
 
 
@@ -44,4 +48,33 @@ class AbstractWindow;
 
 
 // 459
-void exec_long_task_with_busy_animation(std::function<void()>, AbstractWindow &);
+/**
+ * Run a task while showing its progress in the given window. The task runs on its own thread while the
+ * caller is blocked, so it must not call ncurses.
+ *
+ * With a total set on the progress a progress bar with an ETA is drawn, otherwise the busy animation.
+ * Esc requests cancellation, other keys and resizes stay pending until the task is done.
+ *
+ * @param[in] name Name of the task, used for its task_record
+ * @param[in] task The task to run, returning false if it stopped early because of cancellation
+ * @param[in] win The window to draw the progress in
+ * @returns The task's result
+ */
+bool exec_long_task(std::string const & name, std::function<bool (TaskProgress &)> task, AbstractWindow & win);
+
+struct task_record
+{
+    std::string name;
+    uint64_t items;
+    uint64_t total;
+    uint64_t elapsed_ms;
+    bool completed;
+};
+
+/**
+ * Throughput of the most recent long tasks, so that regressions show up in the stats.
+ * Only to be used from the main thread
+ *
+ * @returns Records of the most recent tasks, oldest first
+ */
+std::vector<task_record> const & recent_tasks();
@@ -0,0 +1,131 @@
+#include "frame.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Renderer.h"
+
+
+
+namespace frame
+{
+    static bool stats_on{false};
+    static frame_stats totals{0, 0, 0, 0, 0, 0};
+    static uint64_t frame_number{0};
+
+    // draws of the frame being composed and of the last frame that drew anything
+    static std::vector<draw_record> draws;
+    static std::vector<draw_record> last_draws;
+
+
+    // @returns The number of bytes written by the calling thread so far, or -1 if unknown. Only called from
+    //     the drawing thread, so between two calls around a flush only the renderer's output is counted,
+    //     not what pool threads or the keystroke log write meanwhile
+    static int64_t bytes_written()
+    {
+        static int const fd = open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return -1;
+
+        char buf[512];
+        ssize_t const n = pread(fd, buf, sizeof(buf) - 1, 0);
+        if (n <= 0)
+            return -1;
+        buf[n] = '\0';
+
+        static char const * const label = "wchar: ";
+        char const * wchar = strstr(buf, label);
+        if (nullptr == wchar)
+            return -1;
+
+        return strtoll(wchar + strlen(label), nullptr, 10);
+    }
+
+
+    void flush()
+    {
+        ++frame_number;
+
+        if (!stats_on)
+        {
+            Renderer::get().flush();
+            return;
+        }
+
+        if (draws.size() > 0)
+        {
+            std::swap(draws, last_draws);
+            draws.clear();
+        }
+
+        int64_t const before = bytes_written();
+        Renderer::get().flush();
+        int64_t const after = bytes_written();
+
+        uint64_t const bytes = before < 0 || after < before ? 0 : after - before;
+        ++totals.frames;
+        totals.bytes += bytes;
+        totals.last_bytes = bytes;
+        if (bytes > totals.max_bytes)
+            totals.max_bytes = bytes;
+    }
+
+
+    uint64_t number()
+    {
+        return frame_number;
+    }
+
+
+    void record_draw(std::string const & window, std::string const & reason)
+    {
+        if (!stats_on)
+            return;
+
+        ++totals.windows_drawn;
+        draws.push_back({window, reason});
+    }
+
+
+    void record_skipped_draw()
+    {
+        if (stats_on)
+            ++totals.draws_skipped;
+    }
+
+
+    std::vector<draw_record> const & last_frame_draws()
+    {
+        return last_draws;
+    }
+
+
+    void set_stats_enabled(bool enabled)
+    {
+        stats_on = enabled;
+    }
+
+
+    bool stats_enabled()
+    {
+        return stats_on;
+    }
+
+
+    void reset_stats()
+    {
+        totals = frame_stats{0, 0, 0, 0, 0, 0};
+        draws.clear();
+        last_draws.clear();
+    }
+
+
+    void collect_stats(frame_stats * fs)
+    {
+        *fs = totals;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+    Windows only stage their content with Surface::stage(). A "frame" is everything staged since the last
+    flush(), sent to the terminal with a single Renderer::flush().
+*/
+
+namespace frame
+{
+    /**
+     * Send all staged window content to the terminal with one Renderer::flush()
+     */
+    void flush();
+
+    /**
+     * @returns The number of the frame currently being composed, which is the number of flushes so far
+     */
+    uint64_t number();
+
+    struct frame_stats
+    {
+        uint64_t frames;
+        uint64_t bytes;
+        uint64_t last_bytes;
+        uint64_t max_bytes;
+        uint64_t windows_drawn;
+        uint64_t draws_skipped; // windows that were due for a redraw but were already drawn in the frame
+    };
+
+    struct draw_record
+    {
+        std::string window;
+        std::string reason;
+    };
+
+    /**
+     * Windows report their draws here, see AbstractWindow::draw()
+     *
+     * @param[in] window The title of the window drawn
+     * @param[in] reason Why the window was drawn
+     */
+    void record_draw(std::string const & window, std::string const & reason);
+    void record_skipped_draw();
+
+    /**
+     * @returns The windows drawn in the last frame that drew anything, in drawing order
+     */
+    std::vector<draw_record> const & last_frame_draws();
+
+    /**
+     * When enabled, flush() counts the bytes written to the terminal (wchar of /proc/thread-self/io, which
+     * counts the drawing thread's writes only, taken before and after the renderer's flush) and
+     * windows report their draws. Disabled by default. Only to be used from the thread doing the drawing.
+     */
+    void set_stats_enabled(bool enabled);
+    bool stats_enabled();
+
+    /**
+     * Forget everything recorded so far
+     */
+    void reset_stats();
+
+    /**
+     * @param[out] fs Totals recorded since the last reset_stats()
+     */
+    void collect_stats(frame_stats * fs);
+}
@@ -0,0 +1,179 @@
+#include "keystroke_log.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <ncurses.h>
+
+#include "key_codes.h"
+
+
+
+namespace keystroke_log
+{
+    static char const * const FORMAT_LINE{"completable keystroke log 1"};
+
+    static std::ofstream log;
+    static std::chrono::steady_clock::time_point started;
+
+
+    static uint64_t elapsed_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - started
+        ).count();
+    }
+
+
+    bool start_recording(char const * path, int rows, int cols)
+    {
+        stop_recording();
+
+        log.open(path, std::ios::out | std::ios::trunc);
+        if (!log)
+            return false;
+
+        char const * term = std::getenv("TERM");
+        log << FORMAT_LINE << "\n"
+            << "terminal " << rows << " " << cols << " " << (nullptr == term || *term == '\0' ? "-" : term) << "\n"
+            << std::flush;
+        started = std::chrono::steady_clock::now();
+
+        return true;
+    }
+
+
+    void stop_recording()
+    {
+        if (log.is_open())
+            log.close();
+    }
+
+
+    void record_keys(int const * keys, int count)
+    {
+        if (!log.is_open() || count <= 0)
+            return;
+
+        log << elapsed_ns() << " keys";
+        for (int i = 0; i < count; ++i)
+            log << " " << keys[i];
+
+        // flushed per batch since the sessions worth recording may well end in a crash
+        log << std::endl;
+    }
+
+
+    void record_resize(int rows, int cols)
+    {
+        if (!log.is_open())
+            return;
+
+        log << elapsed_ns() << " resize " << rows << " " << cols << std::endl;
+    }
+
+
+    bool load(char const * path, session & s, std::string & error)
+    {
+        std::ifstream in{path};
+        if (!in)
+        {
+            error = std::string{"failed to open "} + path;
+            return false;
+        }
+
+        std::string line;
+        if (!std::getline(in, line) || line != FORMAT_LINE)
+        {
+            error = std::string{path} + " is not a keystroke log";
+            return false;
+        }
+
+        {
+            std::string label;
+            std::getline(in, line);
+            std::istringstream fields{line};
+            if (!(fields >> label >> s.rows >> s.cols >> s.term) || label != "terminal" || s.rows <= 0 || s.cols <= 0)
+            {
+                error = std::string{path} + ":2: expected terminal <rows> <cols> <TERM>";
+                return false;
+            }
+            if (s.term == "-")
+                s.term.clear();
+        }
+
+        s.batches.clear();
+        for (int line_number = 3; std::getline(in, line); ++line_number)
+        {
+            if (line.empty())
+                continue;
+
+            std::istringstream fields{line};
+            batch b{0, KEYS, {}, 0, 0};
+            std::string kind;
+            bool ok = (bool) (fields >> b.at_ns >> kind);
+
+            if (ok && kind == "keys")
+            {
+                for (int key; fields >> key;)
+                    b.keys.push_back(key);
+                ok = fields.eof() && !b.keys.empty();
+            }
+            else if (ok && kind == "resize")
+            {
+                b.kind = RESIZE;
+                ok = (bool) (fields >> b.rows >> b.cols) && b.rows > 0 && b.cols > 0;
+            }
+            else
+            {
+                ok = false;
+            }
+
+            if (!ok)
+            {
+                error = std::string{path} + ":" + std::to_string(line_number) + ": malformed batch";
+                return false;
+            }
+
+            s.batches.push_back(std::move(b));
+        }
+
+        return true;
+    }
+
+
+    std::string key_label(int key)
+    {
+        if (key > 31 && key < 127)
+            return std::string(1, (char) key);
+
+        if (key >= KEY_F(1) && key <= KEY_F(12))
+            return "<F" + std::to_string(key - KEY_F(0)) + ">";
+
+        switch (key)
+        {
+            case TAB                : return "<TAB>";
+            case ESC                : return "<ESC>";
+            case RETURN             : return "<RET>";
+            case KEY_BACKSPACE      :
+            case BACKSPACE_127      :
+            case BACKSPACE_BKSLSH_B : return "<BS>";
+            case DELETE             : return "<DEL>";
+            case KEY_UP             : return "<UP>";
+            case KEY_DOWN           : return "<DOWN>";
+            case KEY_LEFT           : return "<LEFT>";
+            case KEY_RIGHT          : return "<RIGHT>";
+            case SHIFT_LEFT         : return "<S-LEFT>";
+            case SHIFT_RIGHT        : return "<S-RIGHT>";
+            case PAGE_UP            : return "<PGUP>";
+            case PAGE_DOWN          : return "<PGDN>";
+            case HOME               : return "<HOME>";
+            case END                : return "<END>";
+            case KEY_RESIZE         : return "<RESIZE>";
+        }
+
+        return "<" + std::to_string(key) + ">";
+    }
+}
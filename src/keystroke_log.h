@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+    Sessions are recorded as the batches of keys the main loop reads between two draws, together with
+    terminal resizes, each stamped with the time since recording started. Replaying the batches in the
+    same order, with the same terminal size, repeats the work the session caused.
+
+    The log is plain text, one batch per line:
+
+        completable keystroke log 1
+        terminal <rows> <cols> <TERM>
+        <ns> keys <key> [<key>...]
+        <ns> resize <rows> <cols>
+*/
+
+namespace keystroke_log
+{
+    enum batch_kind
+    {
+        KEYS,
+        RESIZE
+    };
+
+    struct batch
+    {
+        uint64_t at_ns;     // since recording started
+        batch_kind kind;
+        std::vector<int> keys;
+        int rows;           // RESIZE only
+        int cols;           // RESIZE only
+    };
+
+    struct session
+    {
+        int rows;
+        int cols;
+        std::string term;
+        std::vector<batch> batches;
+    };
+
+    /**
+     * Start recording, replacing whatever the file held before
+     *
+     * @param[in] path The file to record to
+     * @param[in] rows The terminal's height
+     * @param[in] cols The terminal's width
+     * @returns true if recording started, false if the file could not be written
+     */
+    bool start_recording(char const * path, int rows, int cols);
+
+    /**
+     * Finish the log, see start_recording(). Does nothing when not recording
+     */
+    void stop_recording();
+
+    /**
+     * Log the keys read for one draw. Does nothing when not recording
+     *
+     * @param[in] keys The keys in the order read
+     * @param[in] count Number of keys
+     */
+    void record_keys(int const * keys, int count);
+
+    /**
+     * Log a terminal resize. Does nothing when not recording
+     *
+     * @param[in] rows The terminal's new height
+     * @param[in] cols The terminal's new width
+     */
+    void record_resize(int rows, int cols);
+
+    /**
+     * @param[in] path A file written by recording
+     * @param[out] s The recorded session
+     * @param[out] error What was wrong with the file when false is returned
+     * @returns true if the file was read
+     */
+    bool load(char const * path, session & s, std::string & error);
+
+    /**
+     * @param[in] key A key as read by wgetch()
+     * @returns The key itself if printable, otherwise its name in angle brackets, for example <TAB>
+     */
+    std::string key_label(int key);
+}
@@ -0,0 +1,251 @@
+#include "latency_report.h"
+
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <string>
+
+
+
+namespace latency_report
+{
+    // bucket 0 counts 0 ns, bucket i > 0 counts [2^(i-1), 2^i) ns, as with matchmaker::function_stats
+    static int const BUCKET_COUNT{32};
+
+    // keys shown ahead of a slow batch
+    static int const PREFIX_KEYS{24};
+
+    // width of the longest histogram bar
+    static int const BAR_WIDTH{40};
+
+    struct histogram
+    {
+        uint64_t counts[BUCKET_COUNT]{};
+        std::vector<uint64_t> sorted;
+    };
+
+
+    static histogram make_histogram(std::vector<sample> const & samples, uint64_t sample::* latency)
+    {
+        histogram h;
+        h.sorted.reserve(samples.size());
+        for (auto const & smp : samples)
+        {
+            uint64_t const ns = smp.*latency;
+            h.counts[std::min((int) std::bit_width(ns), BUCKET_COUNT - 1)]++;
+            h.sorted.push_back(ns);
+        }
+        std::sort(h.sorted.begin(), h.sorted.end());
+
+        return h;
+    }
+
+
+    static uint64_t percentile(std::vector<uint64_t> const & sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        size_t const index = (size_t) (p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+
+    // exclusive upper bound of a bucket's latencies
+    static uint64_t bucket_limit(int b)
+    {
+        return (uint64_t) 1 << b;
+    }
+
+
+    static std::string batch_label(keystroke_log::batch const & b)
+    {
+        std::string label;
+        for (int key : b.keys)
+            label += keystroke_log::key_label(key);
+
+        return label;
+    }
+
+
+    // the last PREFIX_KEYS keys replayed ahead of the given batch
+    static std::string prefix_label(keystroke_log::session const & s, int batch)
+    {
+        std::vector<int> prefix;
+        for (int b = batch - 1; b >= 0 && (int) prefix.size() < PREFIX_KEYS; --b)
+        {
+            auto const & keys = s.batches[b].keys;
+            for (auto it = keys.rbegin(); it != keys.rend() && (int) prefix.size() < PREFIX_KEYS; ++it)
+                prefix.push_back(*it);
+        }
+
+        std::string label;
+        for (auto it = prefix.rbegin(); it != prefix.rend(); ++it)
+            label += keystroke_log::key_label(*it);
+
+        return label;
+    }
+
+
+    static std::vector<sample> worst_samples(std::vector<sample> const & samples, int worst_count)
+    {
+        std::vector<sample> worst{samples};
+        auto const slower = [](sample const & a, sample const & b)
+        {
+            return a.compute_ns + a.draw_ns > b.compute_ns + b.draw_ns;
+        };
+
+        int const count = std::min(worst_count, (int) worst.size());
+        std::partial_sort(worst.begin(), worst.begin() + count, worst.end(), slower);
+        worst.resize(count);
+
+        return worst;
+    }
+
+
+    static void write_text_histogram(std::ostream & out, char const * name, histogram const & h)
+    {
+        out << name << " latency (ns)   p50: " << percentile(h.sorted, 0.5)
+            << "  p99: " << percentile(h.sorted, 0.99)
+            << "  p999: " << percentile(h.sorted, 0.999)
+            << "  max: " << (h.sorted.empty() ? 0 : h.sorted.back()) << "\n";
+
+        int first{BUCKET_COUNT};
+        int last{-1};
+        uint64_t most{0};
+        for (int b = 0; b < BUCKET_COUNT; ++b)
+        {
+            if (h.counts[b] == 0)
+                continue;
+            first = std::min(first, b);
+            last = b;
+            most = std::max(most, h.counts[b]);
+        }
+
+        for (int b = first; b <= last; ++b)
+        {
+            int const bar = (int) ((h.counts[b] * BAR_WIDTH + most - 1) / most);
+            out << "  < " << std::setw(12) << bucket_limit(b) << std::setw(8) << h.counts[b];
+            if (bar > 0)
+                out << "  " << std::string(bar, '#');
+            out << "\n";
+        }
+        out << "\n";
+    }
+
+
+    static void write_text(
+        std::ostream & out,
+        keystroke_log::session const & s,
+        replay_summary const & summary,
+        std::vector<sample> const & samples,
+        int worst_count
+    )
+    {
+        out << "replayed " << summary.keys << " keys in " << samples.size() << " batches, "
+            << summary.resizes << " resizes, " << summary.skipped_keys << " keys skipped (shell mode)\n"
+            << summary.renderer << " " << s.rows << "x" << s.cols << (s.term.empty() ? "" : " " + s.term)
+            << ", " << summary.elapsed_ns / 1000000 << " ms";
+        if (summary.changed_cells > 0)
+            out << ", " << summary.changed_cells << " cells changed";
+        out << "\n\n";
+
+        write_text_histogram(out, "compute", make_histogram(samples, &sample::compute_ns));
+        write_text_histogram(out, "draw", make_histogram(samples, &sample::draw_ns));
+
+        auto const worst = worst_samples(samples, worst_count);
+        if (worst.empty())
+            return;
+
+        out << "slowest batches\n"
+            << std::setw(12) << "total ns" << std::setw(12) << "compute ns" << std::setw(12) << "draw ns"
+            << std::setw(8) << "batch" << "  prefix [keys]\n";
+        for (auto const & smp : worst)
+        {
+            out << std::setw(12) << smp.compute_ns + smp.draw_ns
+                << std::setw(12) << smp.compute_ns
+                << std::setw(12) << smp.draw_ns
+                << std::setw(8) << smp.batch
+                << "  " << prefix_label(s, smp.batch) << " [" << batch_label(s.batches[smp.batch]) << "]\n";
+        }
+    }
+
+
+    static void write_records(
+        std::ostream & out,
+        output_format::Type format,
+        keystroke_log::session const & s,
+        replay_summary const & summary,
+        std::vector<sample> const & samples,
+        int worst_count
+    )
+    {
+        RecordWriter records{out};
+        records.set_format(format);
+
+        records.begin("replay");
+        records.int_field("keys", summary.keys);
+        records.int_field("batches", (int64_t) samples.size());
+        records.int_field("resizes", summary.resizes);
+        records.int_field("skipped_keys", summary.skipped_keys);
+        records.int_field("rows", s.rows);
+        records.int_field("cols", s.cols);
+        records.int_field("elapsed_ns", (int64_t) summary.elapsed_ns);
+        records.string_field("renderer", summary.renderer);
+        records.int_field("changed_cells", (int64_t) summary.changed_cells);
+        records.end();
+
+        histogram const compute = make_histogram(samples, &sample::compute_ns);
+        histogram const draw = make_histogram(samples, &sample::draw_ns);
+
+        for (auto const & [name, h] : {std::pair{"compute", &compute}, std::pair{"draw", &draw}})
+        {
+            records.begin("latency");
+            records.string_field("phase", name);
+            records.int_field("p50_ns", (int64_t) percentile(h->sorted, 0.5));
+            records.int_field("p99_ns", (int64_t) percentile(h->sorted, 0.99));
+            records.int_field("p999_ns", (int64_t) percentile(h->sorted, 0.999));
+            records.int_field("max_ns", (int64_t) (h->sorted.empty() ? 0 : h->sorted.back()));
+            records.end();
+        }
+
+        for (int b = 0; b < BUCKET_COUNT; ++b)
+        {
+            if (compute.counts[b] == 0 && draw.counts[b] == 0)
+                continue;
+
+            records.begin("histogram");
+            records.int_field("below_ns", (int64_t) bucket_limit(b));
+            records.int_field("compute", (int64_t) compute.counts[b]);
+            records.int_field("draw", (int64_t) draw.counts[b]);
+            records.end();
+        }
+
+        for (auto const & smp : worst_samples(samples, worst_count))
+        {
+            records.begin("slowest");
+            records.int_field("batch", smp.batch);
+            records.int_field("compute_ns", (int64_t) smp.compute_ns);
+            records.int_field("draw_ns", (int64_t) smp.draw_ns);
+            records.string_field("prefix", prefix_label(s, smp.batch));
+            records.string_field("keys", batch_label(s.batches[smp.batch]));
+            records.end();
+        }
+    }
+
+
+    void write(
+        std::ostream & out,
+        output_format::Type format,
+        keystroke_log::session const & s,
+        replay_summary const & summary,
+        std::vector<sample> const & samples,
+        int worst_count
+    )
+    {
+        if (format == output_format::text::grab())
+            write_text(out, s, summary, samples, worst_count);
+        else
+            write_records(out, format, s, summary, samples, worst_count);
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "RecordWriter.h"
+#include "keystroke_log.h"
+
+
+/*
+    Summarizes the latencies of a replayed session (see keystroke_log): histograms of the time spent
+    handling keys and drawing the resulting frames, their percentiles, and the batches of keys that took
+    longest together with the keys typed before them.
+*/
+
+namespace latency_report
+{
+    struct sample
+    {
+        int batch;            // index into the session's batches
+        uint64_t compute_ns;  // handling the batch's keys
+        uint64_t draw_ns;     // drawing the frame showing their result
+    };
+
+    struct replay_summary
+    {
+        int keys;
+        int resizes;
+        int skipped_keys;        // keys that would have entered shell mode, and keys typed ahead of them
+        uint64_t elapsed_ns;     // wall clock time of the whole replay
+        char const * renderer;   // "terminal" or "grid"
+        uint64_t changed_cells;  // cells changed by all frames drawn, known for the grid only
+    };
+
+    /**
+     * @param[out] out Where the report is written
+     * @param[in] format text for a report meant to be read, json or tsv for records (see RecordWriter)
+     * @param[in] s The replayed session
+     * @param[in] summary Totals of the replay
+     * @param[in] samples One sample per replayed batch of keys
+     * @param[in] worst_count Number of slowest batches to list
+     */
+    void write(
+        std::ostream & out,
+        output_format::Type format,
+        keystroke_log::session const & s,
+        replay_summary const & summary,
+        std::vector<sample> const & samples,
+        int worst_count
+    );
+}
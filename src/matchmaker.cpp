@@ -1,7 +1,13 @@
 #include "matchmaker.h"
 #include "MatchmakerState.h"
 
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
 
 #ifdef MM_DYNAMIC_LOADING
     #include <dlfcn.h>
@@ -21,6 +27,15 @@ namespace matchmaker
     static void * handle{nullptr};
 #endif
 
+    // held exclusively while the shims below are (un)set, see lock_library()
+    static std::shared_mutex library_mutex;
+
+    // see library_generation()
+    static std::atomic<uint64_t> generation{0};
+
+    // result of the last load_library(), see publish_library_state()
+    static bool library_ok{false};
+
     static int (*shim_count)(){nullptr};
     static char const * (*shim_at)(int, int *){nullptr};
     static int (*shim_lookup)(char const *, bool *){nullptr};
@@ -62,16 +77,213 @@ namespace matchmaker
 
 
 
+    // instrumentation
+    #define instrumented_functions(_f)                                                                     \
+        _f(count) _f(at) _f(lookup) _f(as_longest) _f(from_longest) _f(lengths) _f(length_location)       \
+        _f(ordinal_summation) _f(from_ordinal_summation) _f(parts_of_speech) _f(is_name) _f(is_male_name) \
+        _f(is_female_name) _f(is_place) _f(is_compound) _f(is_acronym) _f(is_phrase) _f(is_used_in_book)  \
+        _f(synonyms) _f(antonyms) _f(definition) _f(embedded) _f(locations) _f(complete) _f(book_count)   \
+        _f(book_title) _f(book_author) _f(chapter_count) _f(chapter_title) _f(chapter_subtitle)           \
+        _f(paragraph_count) _f(word_count) _f(word)
+
+    enum instrumented_function
+    {
+        #define as_enum(_f) fn_##_f,
+        instrumented_functions(as_enum)
+        #undef as_enum
+        INSTRUMENTED_FUNCTION_COUNT
+    };
+
+    static char const * const instrumented_function_names[INSTRUMENTED_FUNCTION_COUNT] = {
+        #define as_name(_f) #_f,
+        instrumented_functions(as_name)
+        #undef as_name
+    };
+
+    static std::atomic<bool> stats_on{false};
+
+    // counters of a single thread, only ever written by the owning thread
+    struct thread_stats
+    {
+        std::atomic<uint64_t> calls[INSTRUMENTED_FUNCTION_COUNT];
+        std::atomic<uint64_t> total_ns[INSTRUMENTED_FUNCTION_COUNT];
+        std::atomic<uint64_t> histogram[INSTRUMENTED_FUNCTION_COUNT][STATS_BUCKET_COUNT];
+
+        thread_stats();
+        ~thread_stats();
+    };
+
+    // plain totals used for exited threads and for the baseline taken by reset_stats()
+    struct stats_totals
+    {
+        uint64_t calls[INSTRUMENTED_FUNCTION_COUNT]{};
+        uint64_t total_ns[INSTRUMENTED_FUNCTION_COUNT]{};
+        uint64_t histogram[INSTRUMENTED_FUNCTION_COUNT][STATS_BUCKET_COUNT]{};
+    };
+
+    // registration of thread_stats happens once per thread so a lock is fine here
+    struct stats_registry
+    {
+        std::mutex m;
+        std::vector<thread_stats *> live;
+        stats_totals retired;
+        stats_totals baseline;
+    };
+
+    static stats_registry & registry()
+    {
+        static stats_registry r;
+        return r;
+    }
+
+    thread_stats::thread_stats()
+    {
+        for (int f = 0; f < INSTRUMENTED_FUNCTION_COUNT; ++f)
+        {
+            calls[f].store(0, std::memory_order_relaxed);
+            total_ns[f].store(0, std::memory_order_relaxed);
+            for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+                histogram[f][b].store(0, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock{registry().m};
+        registry().live.push_back(this);
+    }
+
+    thread_stats::~thread_stats()
+    {
+        auto & r = registry();
+        std::lock_guard<std::mutex> lock{r.m};
+
+        for (int f = 0; f < INSTRUMENTED_FUNCTION_COUNT; ++f)
+        {
+            r.retired.calls[f] += calls[f].load(std::memory_order_relaxed);
+            r.retired.total_ns[f] += total_ns[f].load(std::memory_order_relaxed);
+            for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+                r.retired.histogram[f][b] += histogram[f][b].load(std::memory_order_relaxed);
+        }
+
+        std::erase(r.live, this);
+    }
+
+    static thread_stats & local_stats()
+    {
+        thread_local thread_stats ts;
+        return ts;
+    }
+
+    // single writer per counter, so load + store is enough (no read-modify-write needed)
+    static void bump(std::atomic<uint64_t> & counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    // kept out of line so that the disabled path through stats_scope stays small
+    [[gnu::noinline]] static void record(instrumented_function f, std::chrono::steady_clock::time_point start)
+    {
+        auto const stop = std::chrono::steady_clock::now();
+        uint64_t const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+        int bucket = (int) std::bit_width(ns);
+        if (bucket >= STATS_BUCKET_COUNT)
+            bucket = STATS_BUCKET_COUNT - 1;
+
+        thread_stats & ts = local_stats();
+        bump(ts.calls[f], 1);
+        bump(ts.total_ns[f], ns);
+        bump(ts.histogram[f][bucket], 1);
+    }
+
+    // records a single call when instrumentation was enabled on entry
+    class stats_scope
+    {
+    public:
+        explicit stats_scope(instrumented_function f) : func{f}
+        {
+            if (stats_on.load(std::memory_order_relaxed)) [[unlikely]]
+            {
+                active = true;
+                start = std::chrono::steady_clock::now();
+            }
+        }
+
+        ~stats_scope()
+        {
+            if (active) [[unlikely]]
+                record(func, start);
+        }
+
+    private:
+        instrumented_function func;
+        bool active{false};
+        std::chrono::steady_clock::time_point start;
+    };
+
+
+    // sum of all live and retired threads, caller must hold registry().m
+    static void sum_totals(int f, function_stats * fs)
+    {
+        auto & r = registry();
+
+        fs->calls = r.retired.calls[f];
+        fs->total_ns = r.retired.total_ns[f];
+        for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+            fs->histogram[b] = r.retired.histogram[f][b];
+
+        for (auto ts : r.live)
+        {
+            fs->calls += ts->calls[f].load(std::memory_order_relaxed);
+            fs->total_ns += ts->total_ns[f].load(std::memory_order_relaxed);
+            for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+                fs->histogram[b] += ts->histogram[f][b].load(std::memory_order_relaxed);
+        }
+    }
+
+
+
+    static void unset_library_locked();
+
+
+    std::shared_lock<std::shared_mutex> lock_library()
+    {
+        std::shared_lock<std::shared_mutex> lock{library_mutex};
+        if (nullptr == shim_count)
+            lock.unlock();
+
+        return lock;
+    }
+
+
+    uint64_t library_generation()
+    {
+        return generation;
+    }
+
+
+    void const * library_address()
+    {
+        return reinterpret_cast<void const *>(shim_count);
+    }
+
+
     char * set_library(char const * so_filename)
     {
-        unset_library();
+        char * ret = load_library(so_filename);
+        publish_library_state();
+        return ret;
+    }
+
+
+    char * load_library(char const * so_filename)
+    {
+        std::unique_lock<std::shared_mutex> lock{library_mutex};
+
+        unset_library_locked();
         char * ret = nullptr;
 
 #ifdef MM_DYNAMIC_LOADING
         handle = dlmopen(LM_ID_NEWLM, so_filename, RTLD_NOW);
         if (nullptr == handle)
         {
-            MatchmakerState::Instance::grab().set_state(LibraryState::Unloaded::grab());
             ret = dlerror();
             return ret;
         }
@@ -130,20 +342,41 @@ namespace matchmaker
         init_func(word);
 
 #ifdef MM_DYNAMIC_LOADING
-        if (ok)
+        library_ok = ok;
+#else
+        library_ok = true;
+#endif
+        ++generation;
+
+        return ret;
+    }
+
+
+    void publish_library_state()
+    {
+#ifdef MM_DYNAMIC_LOADING
+        if (library_ok)
             MatchmakerState::Instance::grab().set_state(LibraryState::Loaded::grab());
         else
             MatchmakerState::Instance::grab().set_state(LibraryState::Unloaded::grab());
 #else
         MatchmakerState::Instance::grab().set_state(LibraryState::Linked::grab());
 #endif
-
-        return ret;
     }
 
 
     void unset_library()
     {
+        std::unique_lock<std::shared_mutex> lock{library_mutex};
+        unset_library_locked();
+    }
+
+
+    static void unset_library_locked()
+    {
+        ++generation;
+        library_ok = false;
+
 #ifdef MM_DYNAMIC_LOADING
         if (nullptr != handle)
         {
@@ -188,6 +421,8 @@ namespace matchmaker
 
     int count()
     {
+        stats_scope scope{fn_count};
+
         if (nullptr == shim_count)
             return 0;
 
@@ -197,6 +432,8 @@ namespace matchmaker
 
     char const * at(int index, int * length)
     {
+        stats_scope scope{fn_at};
+
         static char const * empty_str = "";
         if (nullptr == shim_at)
         {
@@ -211,6 +448,8 @@ namespace matchmaker
 
     int lookup(char const * word, bool * found)
     {
+        stats_scope scope{fn_lookup};
+
         if (nullptr == shim_lookup)
             return -1;
 
@@ -220,6 +459,8 @@ namespace matchmaker
 
     int as_longest(int index)
     {
+        stats_scope scope{fn_as_longest};
+
         if (nullptr == shim_as_longest)
             return -1;
 
@@ -229,6 +470,8 @@ namespace matchmaker
 
     int from_longest(int length_index)
     {
+        stats_scope scope{fn_from_longest};
+
         if (nullptr == shim_from_longest)
             return -1;
 
@@ -238,6 +481,8 @@ namespace matchmaker
 
     void lengths(int const * * len_array, int * count)
     {
+        stats_scope scope{fn_lengths};
+
         if (nullptr == shim_lengths)
         {
             *count = 0;
@@ -250,6 +495,8 @@ namespace matchmaker
 
     bool length_location(int length, int * length_index, int * count)
     {
+        stats_scope scope{fn_length_location};
+
         if (nullptr == shim_length_location)
         {
             *length_index = -1;
@@ -263,6 +510,8 @@ namespace matchmaker
 
     int ordinal_summation(int index)
     {
+        stats_scope scope{fn_ordinal_summation};
+
         if (nullptr == shim_ordinal_summation)
             return 0;
 
@@ -272,6 +521,8 @@ namespace matchmaker
 
     void from_ordinal_summation(int summation, int const * * words, int * count)
     {
+        stats_scope scope{fn_from_ordinal_summation};
+
         if (nullptr == shim_from_ordinal_summation)
         {
             *words = nullptr;
@@ -283,6 +534,8 @@ namespace matchmaker
 
     bool parts_of_speech(int index, char const * const * * pos, int8_t const * * flagged, int * count)
     {
+        stats_scope scope{fn_parts_of_speech};
+
         if (nullptr == shim_parts_of_speech)
         {
             *pos = nullptr;
@@ -297,6 +550,8 @@ namespace matchmaker
 
     bool is_name(int index)
     {
+        stats_scope scope{fn_is_name};
+
         if (nullptr == shim_is_name)
             return false;
 
@@ -306,6 +561,8 @@ namespace matchmaker
 
     bool is_male_name(int index)
     {
+        stats_scope scope{fn_is_male_name};
+
         if (nullptr == shim_is_male_name)
             return false;
 
@@ -315,6 +572,8 @@ namespace matchmaker
 
     bool is_female_name(int index)
     {
+        stats_scope scope{fn_is_female_name};
+
         if (nullptr == shim_is_female_name)
             return false;
 
@@ -324,6 +583,8 @@ namespace matchmaker
 
     bool is_place(int index)
     {
+        stats_scope scope{fn_is_place};
+
         if (nullptr == shim_is_place)
             return false;
 
@@ -333,6 +594,8 @@ namespace matchmaker
 
     bool is_compound(int index)
     {
+        stats_scope scope{fn_is_compound};
+
         if (nullptr == shim_is_compound)
             return false;
 
@@ -342,6 +605,8 @@ namespace matchmaker
 
     bool is_acronym(int index)
     {
+        stats_scope scope{fn_is_acronym};
+
         if (nullptr == shim_is_acronym)
             return false;
 
@@ -351,6 +616,8 @@ namespace matchmaker
 
     bool is_phrase(int index)
     {
+        stats_scope scope{fn_is_phrase};
+
         if (nullptr == shim_is_phrase)
             return false;
 
@@ -360,6 +627,8 @@ namespace matchmaker
 
     bool is_used_in_book(int book_index, int index)
     {
+        stats_scope scope{fn_is_used_in_book};
+
         if (nullptr == shim_is_used_in_book)
             return false;
 
@@ -369,6 +638,8 @@ namespace matchmaker
 
     void synonyms(int index, int const * * syn_array, int * count)
     {
+        stats_scope scope{fn_synonyms};
+
         if (nullptr == shim_synonyms)
         {
             *syn_array = nullptr;
@@ -382,6 +653,8 @@ namespace matchmaker
 
     void antonyms(int index, int const * * ant_array, int * count)
     {
+        stats_scope scope{fn_antonyms};
+
         if (nullptr == shim_antonyms)
         {
             *ant_array = nullptr;
@@ -395,6 +668,8 @@ namespace matchmaker
 
     void definition(int index, int const * * def, int * count)
     {
+        stats_scope scope{fn_definition};
+
         if (nullptr == shim_definition)
         {
             *def = nullptr;
@@ -408,6 +683,8 @@ namespace matchmaker
 
     void embedded(int index, int const * * embedded_words, int * count)
     {
+        stats_scope scope{fn_embedded};
+
         if (nullptr == shim_embedded)
         {
             *embedded_words = nullptr;
@@ -428,6 +705,8 @@ namespace matchmaker
         int * count
     )
     {
+        stats_scope scope{fn_locations};
+
         if (nullptr == shim_locations)
         {
             *book_indexes = nullptr;
@@ -444,6 +723,8 @@ namespace matchmaker
 
     void complete(char const * prefix, int * start, int * length)
     {
+        stats_scope scope{fn_complete};
+
         if (nullptr == shim_complete)
         {
             *start = -1;
@@ -457,6 +738,8 @@ namespace matchmaker
 
     int book_count()
     {
+        stats_scope scope{fn_book_count};
+
         if (nullptr == shim_book_count)
             return 0;
 
@@ -466,6 +749,8 @@ namespace matchmaker
 
     void book_title(int book_index, int const * * title, int * count)
     {
+        stats_scope scope{fn_book_title};
+
         if (nullptr == shim_book_title)
         {
             *title = nullptr;
@@ -479,6 +764,8 @@ namespace matchmaker
 
     void book_author(int book_index, int const * * author, int * count)
     {
+        stats_scope scope{fn_book_author};
+
         if (nullptr == shim_book_author)
         {
             *author = nullptr;
@@ -492,6 +779,8 @@ namespace matchmaker
 
     int chapter_count(int book_index)
     {
+        stats_scope scope{fn_chapter_count};
+
         if (nullptr == shim_chapter_count)
             return 0;
 
@@ -501,6 +790,8 @@ namespace matchmaker
 
     void chapter_title(int book_index, int chapter_index, int const * * title, int * count)
     {
+        stats_scope scope{fn_chapter_title};
+
         if (nullptr == shim_chapter_title)
         {
             *title = nullptr;
@@ -514,6 +805,8 @@ namespace matchmaker
 
     void chapter_subtitle(int book_index, int chapter_index, int const * * subtitle, int * count)
     {
+        stats_scope scope{fn_chapter_subtitle};
+
         if (nullptr == shim_chapter_subtitle)
         {
             *subtitle = nullptr;
@@ -527,6 +820,8 @@ namespace matchmaker
 
     int paragraph_count(int book_index, int chapter_index)
     {
+        stats_scope scope{fn_paragraph_count};
+
         if (nullptr == shim_paragraph_count)
             return 0;
 
@@ -536,6 +831,8 @@ namespace matchmaker
 
     int word_count(int book_index, int chapter_index, int paragraph_index)
     {
+        stats_scope scope{fn_word_count};
+
         if (nullptr == shim_word_count)
             return 0;
 
@@ -554,10 +851,90 @@ namespace matchmaker
         bool * referenced
     )
     {
+        stats_scope scope{fn_word};
+
         if (nullptr == shim_word)
             return -1;
 
         return (*shim_word)(book_index, chapter_index, paragraph_index, word_index,
                             ancestors, ancestor_count, index_within_first_ancestor, referenced);
     }
+
+
+    void set_stats_enabled(bool enabled)
+    {
+        stats_on.store(enabled, std::memory_order_relaxed);
+    }
+
+
+    bool stats_enabled()
+    {
+        return stats_on.load(std::memory_order_relaxed);
+    }
+
+
+    void reset_stats()
+    {
+        // counters are owned by their threads, so instead of zeroing them remember where they are now
+        auto & r = registry();
+        std::lock_guard<std::mutex> lock{r.m};
+
+        function_stats fs;
+        for (int f = 0; f < INSTRUMENTED_FUNCTION_COUNT; ++f)
+        {
+            sum_totals(f, &fs);
+            r.baseline.calls[f] = fs.calls;
+            r.baseline.total_ns[f] = fs.total_ns;
+            for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+                r.baseline.histogram[f][b] = fs.histogram[b];
+        }
+    }
+
+
+    int stats_count()
+    {
+        return INSTRUMENTED_FUNCTION_COUNT;
+    }
+
+
+    void collect_stats(int stats_index, function_stats * fs)
+    {
+        if (stats_index < 0 || stats_index >= INSTRUMENTED_FUNCTION_COUNT)
+        {
+            fs->name = "";
+            fs->calls = 0;
+            fs->total_ns = 0;
+            for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+                fs->histogram[b] = 0;
+            return;
+        }
+
+        auto & r = registry();
+        std::lock_guard<std::mutex> lock{r.m};
+
+        sum_totals(stats_index, fs);
+        fs->name = instrumented_function_names[stats_index];
+        fs->calls -= r.baseline.calls[stats_index];
+        fs->total_ns -= r.baseline.total_ns[stats_index];
+        for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+            fs->histogram[b] -= r.baseline.histogram[stats_index][b];
+    }
+
+
+    uint64_t stats_percentile(function_stats const & fs, double p)
+    {
+        if (fs.calls == 0)
+            return 0;
+
+        uint64_t const target = (uint64_t) (p * fs.calls + 0.5);
+        uint64_t seen{0};
+        for (int b = 0; b < STATS_BUCKET_COUNT; ++b)
+        {
+            seen += fs.histogram[b];
+            if (seen >= target && seen > 0)
+                return b == 0 ? 0 : (uint64_t) 1 << b;
+        }
+
+        return (uint64_t) 1 << (STATS_BUCKET_COUNT - 1);
+    }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <shared_mutex>
 
 
 /*
@@ -13,6 +14,36 @@ namespace matchmaker
     char * set_library(char const * so_filename);
     void unset_library();
 
+    /**
+     * set_library() in two steps. load_library() does the loading and may run on any thread while the
+     * main thread waits for it. publish_library_state() then informs the MatchmakerState observers, which
+     * update the UI, and so must run on the main thread.
+     *
+     * @param[in] so_filename The library to load
+     * @returns An error message, or nullptr on success
+     */
+    char * load_library(char const * so_filename);
+    void publish_library_state();
+
+    /**
+     * Threads other than the one setting the library must hold a library lock while calling any of the
+     * functions below. set_library() and unset_library() wait for all library locks to be released
+     *
+     * @returns A lock owning the library, or a lock that owns nothing if no library is set
+     */
+    std::shared_lock<std::shared_mutex> lock_library();
+
+    /**
+     * @returns A number that changes whenever a library is set or unset
+     */
+    uint64_t library_generation();
+
+    /**
+     * @returns An address within the library's code, or nullptr if no library is set. Used to find the
+     *     library's mappings (see memory_accounting::collect_file_mappings())
+     */
+    void const * library_address();
+
     // matchmaker interface
     int count();
     char const * at(int index, int * length);
@@ -63,4 +94,50 @@ namespace matchmaker
         int * index_within_first_ancestor,
         bool * referenced
     );
+
+
+    // instrumentation (call counts and latency histograms for the functions above)
+    static int const STATS_BUCKET_COUNT{32};
+
+    struct function_stats
+    {
+        char const * name;
+        uint64_t calls;
+        uint64_t total_ns;
+
+        // bucket 0 counts calls taking 0 ns, bucket i > 0 counts calls taking [2^(i-1), 2^i) ns
+        uint64_t histogram[STATS_BUCKET_COUNT];
+    };
+
+    /**
+     * Instrumentation is disabled by default. When disabled each call pays only for one relaxed atomic
+     * load. Counters are kept per thread so that recording never takes a lock.
+     */
+    void set_stats_enabled(bool enabled);
+    bool stats_enabled();
+
+    /**
+     * Forget everything recorded so far
+     */
+    void reset_stats();
+
+    /**
+     * @returns The number of instrumented functions
+     */
+    int stats_count();
+
+    /**
+     * Sum up the counters of all threads for a single instrumented function
+     *
+     * @param[in] stats_index Index of the instrumented function within [0..stats_count())
+     * @param[out] fs Totals recorded since the last reset_stats()
+     */
+    void collect_stats(int stats_index, function_stats * fs);
+
+    /**
+     * @param[in] fs Recorded totals as provided by collect_stats()
+     * @param[in] p Percentile given as a fraction, for example 0.99
+     * @returns The upper bound in nanoseconds of the histogram bucket containing the given percentile
+     */
+    uint64_t stats_percentile(function_stats const & fs, double p);
 }
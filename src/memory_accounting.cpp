@@ -0,0 +1,195 @@
+#include "memory_accounting.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+
+
+namespace memory_accounting
+{
+    static std::atomic<uint64_t> held_bytes[COMPONENT_COUNT]{};
+    static std::atomic<uint64_t> peak_bytes[COMPONENT_COUNT]{};
+    static std::atomic<uint64_t> account_count[COMPONENT_COUNT]{};
+
+    // a single mapping as listed by /proc/self/smaps, sizes in bytes
+    struct mapping
+    {
+        uint64_t start;
+        uint64_t end;
+        std::string device;
+        uint64_t inode;
+        std::string path;
+        uint64_t rss;
+        uint64_t pss;
+        uint64_t private_bytes;
+    };
+
+
+    char const * component_name(component c)
+    {
+        switch (c)
+        {
+            case COMPLETION_STACK : return "completion stack";
+            case WORD_CACHES      : return "word caches";
+            case WORD_STACK       : return "word stack";
+            case PARAGRAPH_CACHE  : return "paragraph cache";
+            case COMPONENT_COUNT  : break;
+        }
+
+        return "?";
+    }
+
+
+    account::account(component comp) : c{comp}
+    {
+        ++account_count[c];
+    }
+
+
+    account::~account()
+    {
+        set(0);
+        --account_count[c];
+    }
+
+
+    void account::set(uint64_t bytes)
+    {
+        // unsigned arithmetic wraps around, so adding the difference also works for shrinking
+        uint64_t const total = held_bytes[c].fetch_add(bytes - held) + (bytes - held);
+        held = bytes;
+
+        uint64_t peak = peak_bytes[c].load(std::memory_order_relaxed);
+        while (total > peak && !peak_bytes[c].compare_exchange_weak(peak, total, std::memory_order_relaxed))
+            ;
+    }
+
+
+    uint64_t heap_bytes(std::string const & s)
+    {
+        char const * const object = reinterpret_cast<char const *>(&s);
+        bool const in_place = s.data() >= object && s.data() < object + sizeof(s);
+
+        // 1 for the terminating null character
+        return in_place ? 0 : s.capacity() + 1;
+    }
+
+
+    void collect_stats(component c, component_stats * cs)
+    {
+        cs->bytes = held_bytes[c];
+        cs->peak_bytes = peak_bytes[c];
+        cs->accounts = account_count[c];
+    }
+
+
+    void reset_stats()
+    {
+        for (int c = 0; c < COMPONENT_COUNT; ++c)
+            peak_bytes[c] = held_bytes[c].load();
+    }
+
+
+    static bool read_smaps(std::vector<mapping> & mappings)
+    {
+        std::ifstream in{"/proc/self/smaps"};
+        if (!in)
+            return false;
+
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields{line};
+            std::string first;
+            fields >> first;
+            if (first.empty())
+                continue;
+
+            // a header starting the next mapping: <start>-<end> <perms> <offset> <device> <inode> [<path>]
+            if (first.back() != ':')
+            {
+                mapping m{};
+                char * dash{nullptr};
+                m.start = std::strtoull(first.c_str(), &dash, 16);
+                m.end = *dash == '-' ? std::strtoull(dash + 1, nullptr, 16) : m.start;
+
+                std::string perms;
+                std::string offset;
+                fields >> perms >> offset >> m.device >> m.inode;
+                std::getline(fields >> std::ws, m.path);
+
+                mappings.push_back(std::move(m));
+                continue;
+            }
+
+            if (mappings.empty())
+                continue;
+
+            uint64_t kb{0};
+            fields >> kb;
+            mapping & m = mappings.back();
+            if (first == "Rss:")
+                m.rss = kb * 1024;
+            else if (first == "Pss:")
+                m.pss = kb * 1024;
+            else if (first == "Private_Clean:" || first == "Private_Dirty:")
+                m.private_bytes += kb * 1024;
+        }
+
+        return true;
+    }
+
+
+    static void add_mapping(mapping const & m, mapping_stats * ms)
+    {
+        ++ms->mappings;
+        ms->size += m.end - m.start;
+        ms->rss += m.rss;
+        ms->pss += m.pss;
+        ms->private_bytes += m.private_bytes;
+    }
+
+
+    bool collect_file_mappings(void const * address, mapping_stats * ms)
+    {
+        *ms = mapping_stats{};
+
+        std::vector<mapping> mappings;
+        if (!read_smaps(mappings))
+            return false;
+
+        uint64_t const a = reinterpret_cast<uintptr_t>(address);
+        mapping const * file{nullptr};
+        for (auto const & m : mappings)
+            if (a >= m.start && a < m.end && m.inode != 0)
+                file = &m;
+
+        if (nullptr == file)
+            return true;
+
+        // the same file may be mapped more than once, one mapping per segment
+        ms->path = file->path;
+        for (auto const & m : mappings)
+            if (m.inode == file->inode && m.device == file->device)
+                add_mapping(m, ms);
+
+        return true;
+    }
+
+
+    bool collect_process_mappings(mapping_stats * ms)
+    {
+        *ms = mapping_stats{};
+
+        std::vector<mapping> mappings;
+        if (!read_smaps(mappings))
+            return false;
+
+        for (auto const & m : mappings)
+            add_mapping(m, ms);
+
+        return true;
+    }
+}
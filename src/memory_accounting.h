@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/*
+    Bytes held per component of the program, so that memory reductions can be measured. Each instance of
+    a component owns an account and sets it to the bytes it holds whenever that changes, while the totals
+    of all accounts of a component are kept here together with their peak.
+
+    Resident sizes of whole mappings, such as those of the matchmaker library, are read from
+    /proc/self/smaps instead.
+*/
+
+namespace memory_accounting
+{
+    enum component
+    {
+        COMPLETION_STACK,
+        WORD_CACHES,
+        WORD_STACK,
+        PARAGRAPH_CACHE,
+        COMPONENT_COUNT
+    };
+
+    /**
+     * @param[in] c A component
+     * @returns The component's name, for example "word caches"
+     */
+    char const * component_name(component c);
+
+    /**
+     * The bytes held by one instance of a component. Any thread may set an account, but only one at a time
+     */
+    class account
+    {
+    public:
+        account(account const &) = delete;
+        account & operator=(account const &) = delete;
+
+        explicit account(component c);
+        ~account();
+
+        /**
+         * @param[in] bytes Everything the instance holds now, including what it allocated on the heap
+         */
+        void set(uint64_t bytes);
+        uint64_t get() const { return held; }
+
+    private:
+        component const c;
+        uint64_t held{0};
+    };
+
+    /**
+     * @param[in] s A string
+     * @returns The bytes the string allocated on the heap, 0 while it fits into the string itself
+     */
+    uint64_t heap_bytes(std::string const & s);
+
+    template<typename T>
+    uint64_t heap_bytes(std::vector<T> const & v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    struct component_stats
+    {
+        uint64_t bytes;       // held by all accounts of the component now
+        uint64_t peak_bytes;  // most held at once since the last reset_stats()
+        uint64_t accounts;    // instances of the component
+    };
+
+    /**
+     * @param[in] c A component
+     * @param[out] cs The component's totals
+     */
+    void collect_stats(component c, component_stats * cs);
+
+    /**
+     * Restart the peaks from what is held now
+     */
+    void reset_stats();
+
+    struct mapping_stats
+    {
+        std::string path;        // file mapped, empty for totals over files and anonymous memory
+        uint64_t mappings;
+        uint64_t size;           // address space
+        uint64_t rss;            // resident
+        uint64_t pss;            // resident, with pages shared with other processes divided among them
+        uint64_t private_bytes;  // resident and not shared with other processes
+    };
+
+    /**
+     * Sum up all mappings of the file mapped at the given address, for example all segments of a library
+     *
+     * @param[in] address Any address within one of the file's mappings
+     * @param[out] ms The sizes in bytes, all 0 if the address is not within a mapped file
+     * @returns false if /proc/self/smaps could not be read
+     */
+    bool collect_file_mappings(void const * address, mapping_stats * ms);
+
+    /**
+     * @param[out] ms The sizes in bytes summed up over all mappings of the process
+     * @returns false if /proc/self/smaps could not be read
+     */
+    bool collect_process_mappings(mapping_stats * ms);
+}
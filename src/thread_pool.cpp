@@ -0,0 +1,283 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+
+namespace thread_pool
+{
+    struct task_queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> lanes[LANE_COUNT];
+    };
+
+    struct lane_counters
+    {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> depth{0};
+        std::atomic<uint64_t> max_depth{0};
+    };
+
+    // serializes set_size()
+    static std::mutex resize_mutex;
+
+    // guards workers, started and stopping, and is what idle workers wait on
+    static std::mutex pool_mutex;
+    static std::condition_variable pool_cv;
+    static std::vector<std::thread> workers;
+    static bool started{false};
+    static bool stopping{false};
+
+    // one queue per worker, only replaced while no worker is running (see set_size())
+    static std::vector<std::unique_ptr<task_queue>> queues;
+
+    // tasks posted from outside the pool
+    static task_queue shared_queue;
+
+    // tasks queued in all lanes, incremented while holding pool_mutex so that no wakeup is lost
+    static std::atomic<uint64_t> queued{0};
+
+    static lane_counters counters[LANE_COUNT];
+
+    // index into queues for pool threads, -1 for any other thread
+    static thread_local int worker_index{-1};
+
+
+    static void work(int index);
+    static void stop();
+    static int hardware_size();
+
+
+    // workers are joined before any of the above is destroyed
+    static struct shutdown
+    {
+        ~shutdown() { stop(); }
+    } shutdown_at_exit;
+
+
+    char const * lane_name(lane l)
+    {
+        switch (l)
+        {
+            case INTERACTIVE : return "interactive";
+            case IDLE        : return "idle";
+            case LANE_COUNT  : break;
+        }
+
+        return "";
+    }
+
+
+    void set_size(int threads)
+    {
+        if (threads <= 0)
+            threads = hardware_size();
+
+        std::lock_guard<std::mutex> resizing{resize_mutex};
+        {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            started = true;
+            if ((int) workers.size() == threads)
+                return;
+        }
+
+        stop();
+
+        std::lock_guard<std::mutex> lock{pool_mutex};
+
+        // keep whatever the old workers left queued
+        std::lock_guard<std::mutex> shared_lock{shared_queue.mutex};
+        for (auto & q : queues)
+            for (int l = 0; l < LANE_COUNT; ++l)
+                for (auto & task : q->lanes[l])
+                    shared_queue.lanes[l].push_back(std::move(task));
+
+        queues.clear();
+        for (int i = 0; i < threads; ++i)
+            queues.push_back(std::make_unique<task_queue>());
+
+        stopping = false;
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back(work, i);
+    }
+
+
+    int size()
+    {
+        std::lock_guard<std::mutex> lock{pool_mutex};
+        return (int) workers.size();
+    }
+
+
+    void post(lane l, std::function<void()> task)
+    {
+        bool start{false};
+        {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            start = !started;
+        }
+        if (start)
+            set_size(0);
+
+        // counted before the task is queued, since a worker may take it right away and count it down
+        ++counters[l].submitted;
+        uint64_t const depth = ++counters[l].depth;
+        uint64_t max_depth = counters[l].max_depth.load();
+        while (depth > max_depth && !counters[l].max_depth.compare_exchange_weak(max_depth, depth))
+            ;
+
+        {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            ++queued;
+        }
+
+        // workers queue their own tasks to take them while still hot in cache, others share a queue
+        task_queue & q = worker_index == -1 ? shared_queue : *queues[worker_index];
+        {
+            std::lock_guard<std::mutex> lock{q.mutex};
+            q.lanes[l].push_back(std::move(task));
+        }
+        pool_cv.notify_one();
+    }
+
+
+    // take the newest (back) or oldest (front) task of a lane
+    static bool take(task_queue & q, int l, bool newest, std::function<void()> & task)
+    {
+        std::lock_guard<std::mutex> lock{q.mutex};
+
+        auto & lane_queue = q.lanes[l];
+        if (lane_queue.empty())
+            return false;
+
+        if (newest)
+        {
+            task = std::move(lane_queue.back());
+            lane_queue.pop_back();
+        }
+        else
+        {
+            task = std::move(lane_queue.front());
+            lane_queue.pop_front();
+        }
+
+        --counters[l].depth;
+        --queued;
+
+        return true;
+    }
+
+
+    bool run_pending_task(lane lowest)
+    {
+        if (queued.load() == 0)
+            return false;
+
+        std::function<void()> task;
+        int const queue_count = (int) queues.size();
+
+        for (int l = 0; l <= lowest; ++l)
+        {
+            bool found = false;
+
+            if (worker_index != -1)
+                found = take(*queues[worker_index], l, true, task);
+
+            if (!found)
+                found = take(shared_queue, l, false, task);
+
+            // steal, starting with the next worker so that victims are spread out
+            for (int i = 1; !found && i <= queue_count; ++i)
+            {
+                int const victim = (worker_index + i + queue_count) % queue_count;
+                if (victim == worker_index)
+                    continue;
+
+                found = take(*queues[victim], l, false, task);
+                if (found)
+                    ++counters[l].stolen;
+            }
+
+            if (found)
+            {
+                task();
+                ++counters[l].completed;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    void collect_stats(lane l, lane_stats * ls)
+    {
+        ls->submitted = counters[l].submitted;
+        ls->completed = counters[l].completed;
+        ls->stolen = counters[l].stolen;
+        ls->depth = counters[l].depth;
+        ls->max_depth = counters[l].max_depth;
+    }
+
+
+    void reset_stats()
+    {
+        for (auto & c : counters)
+        {
+            c.submitted = 0;
+            c.completed = 0;
+            c.stolen = 0;
+            c.max_depth = c.depth.load();
+        }
+    }
+
+
+    static void work(int index)
+    {
+        worker_index = index;
+
+        while (true)
+        {
+            // checked before every task, so that stopping leaves the remaining tasks queued
+            {
+                std::unique_lock<std::mutex> lock{pool_mutex};
+                pool_cv.wait(lock, []() { return stopping || queued > 0; });
+                if (stopping)
+                    return;
+            }
+
+            run_pending_task();
+        }
+    }
+
+
+    // let running tasks finish and join all workers, queued tasks stay queued
+    static void stop()
+    {
+        std::vector<std::thread> stopped;
+        {
+            std::lock_guard<std::mutex> lock{pool_mutex};
+            stopping = true;
+            std::swap(stopped, workers);
+        }
+        pool_cv.notify_all();
+
+        for (auto & t : stopped)
+            t.join();
+    }
+
+
+    static int hardware_size()
+    {
+        return std::max(1, (int) std::thread::hardware_concurrency());
+    }
+}
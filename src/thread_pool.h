@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+/*
+    One pool of worker threads shared by all background work, so that parallel work never runs more
+    threads than the pool has. Each worker has its own queue, taking its own most recent task first and
+    stealing the oldest tasks of other workers when out of work. Tasks posted from outside the pool go to
+    a shared queue.
+
+    Tasks must not call ncurses, see event_loop.
+*/
+
+namespace thread_pool
+{
+    // priority lanes, a queued interactive task is always taken before any idle task
+    enum lane
+    {
+        INTERACTIVE, // somebody is waiting for the result
+        IDLE,        // results are welcome whenever they are ready (prefetching)
+        LANE_COUNT
+    };
+
+    /**
+     * @param[in] l A lane
+     * @returns The lane's name
+     */
+    char const * lane_name(lane l);
+
+    /**
+     * Start or restart the pool with the given number of worker threads. Queued tasks are kept, running
+     * tasks are waited for. Must not be called from a pool task.
+     * The pool starts with as many threads as the hardware supports when first used without this call
+     *
+     * @param[in] threads The number of worker threads, or 0 for the hardware's concurrency
+     */
+    void set_size(int threads);
+
+    /**
+     * @returns The number of worker threads
+     */
+    int size();
+
+    /**
+     * Queue a task to be run by a worker thread. Safe to call from any thread
+     *
+     * @param[in] l The lane to queue the task in
+     * @param[in] task The task to run
+     */
+    void post(lane l, std::function<void()> task);
+
+    /**
+     * Queue a task to be run by a worker thread. Safe to call from any thread
+     *
+     * @param[in] l The lane to queue the task in
+     * @param[in] f The task to run
+     * @returns A future for the task's result
+     */
+    template<typename F>
+    auto submit(lane l, F && f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using result_type = std::invoke_result_t<std::decay_t<F>>;
+
+        // std::function needs to be copyable, std::packaged_task is not
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+        std::future<result_type> result = task->get_future();
+        post(l, [task]() { (*task)(); });
+
+        return result;
+    }
+
+    /**
+     * Run one queued task, interactive first, on the calling thread
+     *
+     * @param[in] lowest The lowest priority lane to take a task from, INTERACTIVE leaves idle tasks queued
+     * @returns true if a task was run, false if there was none queued
+     */
+    bool run_pending_task(lane lowest = IDLE);
+
+    /**
+     * Wait for a future, running queued interactive tasks meanwhile. Pool tasks waiting for other pool
+     * tasks must use this instead of std::future::get() so that a pool busy with waiting tasks still makes
+     * progress, which also means that tasks waited for by pool tasks must be INTERACTIVE.
+     * Idle tasks are never run by the waiting thread, so that waiting on the UI thread takes no longer
+     * than what is waited for
+     *
+     * @param[in] f The future to wait for
+     * @returns The future's result
+     */
+    template<typename T>
+    T get(std::future<T> & f)
+    {
+        while (f.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            // once nothing interactive is queued anymore, whatever f waits for is already running
+            if (!run_pending_task(INTERACTIVE))
+                break;
+        }
+
+        return f.get();
+    }
+
+    struct lane_stats
+    {
+        uint64_t submitted;
+        uint64_t completed;
+        uint64_t stolen;     // tasks taken from another worker's queue
+        uint64_t depth;      // tasks currently queued
+        uint64_t max_depth;
+    };
+
+    /**
+     * @param[in] l The lane to collect statistics for
+     * @param[out] ls Totals recorded since the last reset_stats()
+     */
+    void collect_stats(lane l, lane_stats * ls);
+
+    /**
+     * Forget everything recorded so far, except for the current queue depths
+     */
+    void reset_stats();
+}
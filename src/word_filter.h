@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 #include <matchable/matchable.h>
 
@@ -64,6 +65,9 @@ struct word_filter
     filter_direction::Type direction{filter_direction::exclusive::grab()};
     filter_logic::Type logic{filter_logic::and_logic::grab()};
 
+    // incremented with every change to the fields above so that filtered results can be cached
+    uint64_t version{0};
+
     bool passes(int word) const
     {
         if (logic == filter_logic::or_logic::grab())
@@ -107,4 +111,18 @@ struct word_filter
 
         return false;
     }
+
+    /**
+     * @param[in] words Words to filter
+     * @param[in] count Number of words
+     * @param[out] passing Receives the words that pass, in order
+     */
+    void apply(int const * words, int count, std::vector<int> & passing) const
+    {
+        passing.clear();
+        passing.reserve(count);
+        for (int i = 0; i < count; ++i)
+            if (passes(words[i]))
+                passing.push_back(words[i]);
+    }
 };
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "synthetic_format.h"
+
+
+
+/*
+    Generates a synthetic dictionary file for the stand-in matchmaker library (see
+    matchmaker_synthetic.cpp). Everything is derived from the seed, so equal arguments give equal files.
+
+    Term j consists of a fixed width prefix, spreading the terms evenly over the alphabet so that
+    completions behave like those of a real dictionary, followed by up to MAX_SUFFIX pseudo random letters.
+    Since the prefixes are unique and increasing, the terms are generated already sorted.
+*/
+
+namespace
+{
+    int const MAX_SUFFIX{6};
+
+    // book words are drawn from this many of the most frequent terms, with lower ranks more likely
+    uint64_t const VOCABULARY{20000};
+
+    struct options
+    {
+        uint64_t terms{1000000};
+        double attribute_density{0.05};
+        uint64_t synonyms{4};
+        uint64_t books{2};
+        uint64_t chapters{20};
+        uint64_t paragraphs{50};
+        uint64_t words{40};
+        uint64_t seed{1};
+        std::string out;
+    };
+
+    // salts keep the pseudo random streams of different properties independent
+    enum salt : uint64_t
+    {
+        SUFFIX_LENGTH = 1, SUFFIX, ATTRIBUTE, POS, SYNONYM, ANTONYM, DEFINITION, EMBEDDED_TERM, BOOK_WORD,
+        TITLE
+    };
+
+
+    uint64_t mix(uint64_t seed, uint64_t a, uint64_t b)
+    {
+        // splitmix64 finalizer
+        uint64_t z = seed * 0x9e3779b97f4a7c15ULL + a * 0xbf58476d1ce4e5b9ULL + b * 0x94d049bb133111ebULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+
+    double unit(uint64_t h)
+    {
+        return (double) (h >> 11) / (double) (1ULL << 53);
+    }
+
+
+    // writes sections after a header that is filled in last
+    class section_writer
+    {
+    public:
+        explicit section_writer(FILE * f) : f{f}, offset{sizeof(synthetic::header)}
+        {
+            ok = std::fseek(f, (long) offset, SEEK_SET) == 0;
+        }
+
+        template<typename T>
+        void write(synthetic::header & h, synthetic::section s, std::vector<T> const & data)
+        {
+            static char const padding[8] = {};
+            uint64_t const padding_size = (8 - offset % 8) % 8;
+            ok = ok && std::fwrite(padding, 1, padding_size, f) == padding_size;
+            offset += padding_size;
+
+            h.section_offsets[s] = offset;
+            h.section_sizes[s] = data.size() * sizeof(T);
+            ok = ok && std::fwrite(data.data(), sizeof(T), data.size(), f) == data.size();
+            offset += h.section_sizes[s];
+        }
+
+        bool finish(synthetic::header const & h)
+        {
+            ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(&h, sizeof(h), 1, f) == 1;
+            return ok;
+        }
+
+        uint64_t size() const { return offset; }
+
+    private:
+        FILE * f;
+        uint64_t offset;
+        bool ok;
+    };
+
+
+    // build offsets and a flat list from per term counts and a function providing the i-th entry
+    template<typename Count, typename Entry>
+    void build_lists(uint64_t term_count, std::vector<uint32_t> & offsets, std::vector<int32_t> & entries,
+                     Count count_of, Entry entry_of)
+    {
+        offsets.assign(term_count + 1, 0);
+        for (uint64_t t = 0; t < term_count; ++t)
+            offsets[t + 1] = offsets[t] + (uint32_t) count_of(t);
+
+        entries.resize(offsets[term_count]);
+        for (uint64_t t = 0; t < term_count; ++t)
+            for (uint32_t i = offsets[t]; i < offsets[t + 1]; ++i)
+                entries[i] = (int32_t) entry_of(t, i - offsets[t]);
+    }
+
+
+    bool parse(int argc, char ** argv, options & o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string const arg{argv[i]};
+            if (i + 1 >= argc)
+                return false;
+
+            char const * value = argv[++i];
+            if (arg == "--terms")
+                o.terms = std::strtoull(value, nullptr, 10);
+            else if (arg == "--attribute-density")
+                o.attribute_density = std::strtod(value, nullptr);
+            else if (arg == "--synonyms")
+                o.synonyms = std::strtoull(value, nullptr, 10);
+            else if (arg == "--books")
+                o.books = std::strtoull(value, nullptr, 10);
+            else if (arg == "--chapters")
+                o.chapters = std::strtoull(value, nullptr, 10);
+            else if (arg == "--paragraphs")
+                o.paragraphs = std::strtoull(value, nullptr, 10);
+            else if (arg == "--words")
+                o.words = std::strtoull(value, nullptr, 10);
+            else if (arg == "--seed")
+                o.seed = std::strtoull(value, nullptr, 10);
+            else if (arg == "--out")
+                o.out = value;
+            else
+                return false;
+        }
+
+        return !o.out.empty() && o.terms > 0 && o.terms <= INT32_MAX && o.attribute_density >= 0.0
+               && o.attribute_density <= 1.0;
+    }
+}
+
+
+
+int main(int argc, char ** argv)
+{
+    options o;
+    if (!parse(argc, argv, o))
+    {
+        std::cerr << "usage: " << argv[0] << " --out <file> [--terms <count>] [--attribute-density <0..1>]"
+                  << " [--synonyms <mean count>] [--books <count>] [--chapters <per book>]"
+                  << " [--paragraphs <per chapter>] [--words <per paragraph>] [--seed <seed>]\n";
+        return EXIT_FAILURE;
+    }
+
+    uint64_t const n = o.terms;
+    synthetic::header h{};
+    std::memcpy(h.magic, synthetic::MAGIC, sizeof(h.magic));
+    h.term_count = n;
+    h.book_count = o.books;
+    h.chapters_per_book = o.chapters;
+    h.paragraphs_per_chapter = o.paragraphs;
+    h.words_per_paragraph = o.words;
+
+    // terms
+    int prefix_width{1};
+    uint64_t prefix_space{26};
+    while (prefix_space < n)
+    {
+        ++prefix_width;
+        prefix_space *= 26;
+    }
+
+    std::vector<uint64_t> term_offsets(n + 1, 0);
+    std::vector<char> term_chars;
+    term_chars.reserve(n * (prefix_width + MAX_SUFFIX / 2 + 1));
+    std::vector<int32_t> term_lengths(n);
+    std::vector<int32_t> ordinal_sums(n);
+    for (uint64_t t = 0; t < n; ++t)
+    {
+        term_offsets[t] = term_chars.size();
+
+        uint64_t code = (uint64_t) ((unsigned __int128) t * prefix_space / n);
+        char prefix[16];
+        for (int i = prefix_width - 1; i >= 0; --i)
+        {
+            prefix[i] = (char) ('a' + code % 26);
+            code /= 26;
+        }
+        term_chars.insert(term_chars.end(), prefix, prefix + prefix_width);
+
+        int const suffix_length = (int) (mix(o.seed, SUFFIX_LENGTH, t) % (MAX_SUFFIX + 1));
+        for (int i = 0; i < suffix_length; ++i)
+            term_chars.push_back((char) ('a' + mix(o.seed, SUFFIX + i * 0x100, t) % 26));
+
+        term_lengths[t] = prefix_width + suffix_length;
+
+        int32_t sum{0};
+        for (uint64_t i = term_offsets[t]; i < term_chars.size(); ++i)
+            sum += term_chars[i] - 'a' + 1;
+        ordinal_sums[t] = sum;
+        h.max_ordinal_sum = std::max(h.max_ordinal_sum, (uint64_t) sum);
+
+        term_chars.push_back('\0');
+    }
+    term_offsets[n] = term_chars.size();
+
+    // length order, longest first
+    int const max_length = prefix_width + MAX_SUFFIX;
+    std::vector<int32_t> from_longest;
+    std::vector<int32_t> as_longest(n);
+    std::vector<int32_t> lengths;
+    std::vector<int32_t> length_starts;
+    std::vector<int32_t> length_counts;
+    {
+        std::vector<std::vector<int32_t>> by_length(max_length + 1);
+        for (uint64_t t = 0; t < n; ++t)
+            by_length[term_lengths[t]].push_back((int32_t) t);
+
+        for (int len = max_length; len > 0; --len)
+        {
+            if (by_length[len].empty())
+                continue;
+
+            lengths.push_back(len);
+            length_starts.push_back((int32_t) from_longest.size());
+            length_counts.push_back((int32_t) by_length[len].size());
+            for (int32_t t : by_length[len])
+            {
+                as_longest[t] = (int32_t) from_longest.size();
+                from_longest.push_back(t);
+            }
+        }
+    }
+
+    // ordinal sum groups
+    std::vector<uint32_t> sum_offsets(h.max_ordinal_sum + 2, 0);
+    std::vector<int32_t> sum_terms(n);
+    {
+        for (uint64_t t = 0; t < n; ++t)
+            ++sum_offsets[ordinal_sums[t] + 1];
+        for (uint64_t s = 1; s < sum_offsets.size(); ++s)
+            sum_offsets[s] += sum_offsets[s - 1];
+
+        std::vector<uint32_t> next(sum_offsets.begin(), sum_offsets.end() - 1);
+        for (uint64_t t = 0; t < n; ++t)
+            sum_terms[next[ordinal_sums[t]]++] = (int32_t) t;
+    }
+
+    // attributes and parts of speech
+    std::vector<uint8_t> attributes(n, 0);
+    std::vector<uint8_t> pos_masks(n, 0);
+    for (uint64_t t = 0; t < n; ++t)
+    {
+        for (uint8_t bit : {synthetic::NAME, synthetic::PLACE, synthetic::COMPOUND, synthetic::ACRONYM,
+                            synthetic::PHRASE})
+            if (unit(mix(o.seed, ATTRIBUTE + bit * 0x100, t)) < o.attribute_density)
+                attributes[t] |= bit;
+
+        if (attributes[t] & synthetic::NAME)
+            attributes[t] |= (mix(o.seed, ATTRIBUTE, t) & 1) ? synthetic::MALE_NAME : synthetic::FEMALE_NAME;
+
+        uint64_t const p = mix(o.seed, POS, t);
+        pos_masks[t] = (uint8_t) (1 << (p % synthetic::POS_COUNT));
+        if ((p >> 8) % 4 == 0)
+            pos_masks[t] |= (uint8_t) (1 << ((p >> 16) % synthetic::POS_COUNT));
+    }
+
+    // related terms
+    auto random_term = [&](uint64_t salt, uint64_t t, uint64_t i) { return mix(o.seed, salt + i * 0x100, t) % n; };
+
+    auto frequent_term = [&](uint64_t salt, uint64_t a, uint64_t b)
+    {
+        double const u = unit(mix(o.seed, salt + a * 0x100, b));
+        uint64_t const rank = (uint64_t) (std::min(VOCABULARY, n) * u * u);
+        return (rank * 2654435761ULL + o.seed) % n;
+    };
+
+    std::vector<uint32_t> synonym_offsets;
+    std::vector<int32_t> synonyms;
+    build_lists(n, synonym_offsets, synonyms,
+        [&](uint64_t t) { return mix(o.seed, SYNONYM, t) % (2 * o.synonyms + 1); },
+        [&](uint64_t t, uint64_t i) { return random_term(SYNONYM, t, i + 1); }
+    );
+
+    std::vector<uint32_t> antonym_offsets;
+    std::vector<int32_t> antonyms;
+    build_lists(n, antonym_offsets, antonyms,
+        [&](uint64_t t) { uint64_t a = mix(o.seed, ANTONYM, t); return a % 4 == 0 ? 1 + (a >> 8) % 2 : 0; },
+        [&](uint64_t t, uint64_t i) { return random_term(ANTONYM, t, i + 1); }
+    );
+
+    std::vector<uint32_t> definition_offsets;
+    std::vector<int32_t> definitions;
+    build_lists(n, definition_offsets, definitions,
+        [&](uint64_t t) { uint64_t d = mix(o.seed, DEFINITION, t); return d % 2 == 0 ? 3 + (d >> 8) % 6 : 0; },
+        [&](uint64_t t, uint64_t i) { return frequent_term(DEFINITION, i + 1, t); }
+    );
+
+    std::vector<uint32_t> embedded_offsets;
+    std::vector<int32_t> embedded;
+    build_lists(n, embedded_offsets, embedded,
+        [&](uint64_t t) { return (attributes[t] & synthetic::COMPOUND) ? 2 : 0; },
+        [&](uint64_t t, uint64_t i) { return random_term(EMBEDDED_TERM, t, i + 1); }
+    );
+
+    // books
+    uint64_t const words_per_book = o.chapters * o.paragraphs * o.words;
+    std::vector<int32_t> book_words(o.books * words_per_book);
+    for (uint64_t i = 0; i < book_words.size(); ++i)
+        book_words[i] = (int32_t) frequent_term(BOOK_WORD, 0, i);
+
+    std::vector<int32_t> book_titles;
+    for (uint64_t b = 0; b < o.books * (synthetic::TITLE_TERMS + synthetic::AUTHOR_TERMS); ++b)
+        book_titles.push_back((int32_t) random_term(TITLE, b, 0));
+
+    std::vector<int32_t> chapter_titles;
+    for (uint64_t c = 0; c < o.books * o.chapters * (synthetic::TITLE_TERMS + synthetic::SUBTITLE_TERMS); ++c)
+        chapter_titles.push_back((int32_t) random_term(TITLE, c, 1));
+
+    // locations, grouped by term in book order
+    std::vector<uint32_t> location_offsets(n + 1, 0);
+    std::vector<int32_t> location_books(book_words.size());
+    std::vector<int32_t> location_chapters(book_words.size());
+    std::vector<int32_t> location_paragraphs(book_words.size());
+    std::vector<int32_t> location_words(book_words.size());
+    {
+        for (int32_t t : book_words)
+            ++location_offsets[t + 1];
+        for (uint64_t t = 1; t <= n; ++t)
+            location_offsets[t] += location_offsets[t - 1];
+
+        std::vector<uint32_t> next(location_offsets.begin(), location_offsets.end() - 1);
+        for (uint64_t i = 0; i < book_words.size(); ++i)
+        {
+            uint32_t const l = next[book_words[i]]++;
+            location_books[l] = (int32_t) (i / words_per_book);
+            location_chapters[l] = (int32_t) (i / (o.paragraphs * o.words) % o.chapters);
+            location_paragraphs[l] = (int32_t) (i / o.words % o.paragraphs);
+            location_words[l] = (int32_t) (i % o.words);
+        }
+    }
+
+    // write
+    FILE * f = std::fopen(o.out.c_str(), "wb");
+    if (nullptr == f)
+    {
+        std::cerr << "failed to open " << o.out << "\n";
+        return EXIT_FAILURE;
+    }
+
+    section_writer w{f};
+    w.write(h, synthetic::TERM_OFFSETS, term_offsets);
+    w.write(h, synthetic::TERM_CHARS, term_chars);
+    w.write(h, synthetic::FROM_LONGEST, from_longest);
+    w.write(h, synthetic::AS_LONGEST, as_longest);
+    w.write(h, synthetic::LENGTHS, lengths);
+    w.write(h, synthetic::LENGTH_STARTS, length_starts);
+    w.write(h, synthetic::LENGTH_COUNTS, length_counts);
+    w.write(h, synthetic::ATTRIBUTES, attributes);
+    w.write(h, synthetic::POS_MASKS, pos_masks);
+    w.write(h, synthetic::ORDINAL_SUMS, ordinal_sums);
+    w.write(h, synthetic::SUM_OFFSETS, sum_offsets);
+    w.write(h, synthetic::SUM_TERMS, sum_terms);
+    w.write(h, synthetic::SYNONYM_OFFSETS, synonym_offsets);
+    w.write(h, synthetic::SYNONYMS, synonyms);
+    w.write(h, synthetic::ANTONYM_OFFSETS, antonym_offsets);
+    w.write(h, synthetic::ANTONYMS, antonyms);
+    w.write(h, synthetic::DEFINITION_OFFSETS, definition_offsets);
+    w.write(h, synthetic::DEFINITIONS, definitions);
+    w.write(h, synthetic::EMBEDDED_OFFSETS, embedded_offsets);
+    w.write(h, synthetic::EMBEDDED, embedded);
+    w.write(h, synthetic::BOOK_WORDS, book_words);
+    w.write(h, synthetic::BOOK_TITLES, book_titles);
+    w.write(h, synthetic::CHAPTER_TITLES, chapter_titles);
+    w.write(h, synthetic::LOCATION_OFFSETS, location_offsets);
+    w.write(h, synthetic::LOCATION_BOOKS, location_books);
+    w.write(h, synthetic::LOCATION_CHAPTERS, location_chapters);
+    w.write(h, synthetic::LOCATION_PARAGRAPHS, location_paragraphs);
+    w.write(h, synthetic::LOCATION_WORDS, location_words);
+
+    bool const written = w.finish(h);
+    if (std::fclose(f) != 0 || !written)
+    {
+        std::cerr << "failed to write " << o.out << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "wrote " << n << " terms (" << w.size() << " bytes) to " << o.out << "\n";
+
+    return EXIT_SUCCESS;
+}
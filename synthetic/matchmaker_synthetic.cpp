@@ -0,0 +1,489 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "synthetic_format.h"
+
+
+
+/*
+    A stand-in for the matchmaker library providing the mm_* functions that matchmaker::set_library()
+    resolves, backed by a dictionary file made by matchmaker_synthetic_generate. The file is named by the
+    MM_SYNTHETIC_DICTIONARY environment variable and mapped when the library is loaded. Without a valid
+    file the dictionary is empty.
+*/
+
+namespace
+{
+    synthetic::header const * h{nullptr};
+    size_t mapped_size{0};
+    int term_count{0};
+
+    template<typename T>
+    T const * section(synthetic::section s)
+    {
+        return reinterpret_cast<T const *>(reinterpret_cast<char const *>(h) + h->section_offsets[s]);
+    }
+
+    uint64_t const * term_offsets{nullptr};
+    char const * term_chars{nullptr};
+    int32_t const * from_longest_terms{nullptr};
+    int32_t const * as_longest_positions{nullptr};
+    int32_t const * lengths{nullptr};
+    int length_count{0};
+    int32_t const * length_starts{nullptr};
+    int32_t const * length_counts{nullptr};
+    uint8_t const * attributes{nullptr};
+    uint8_t const * pos_masks{nullptr};
+    int32_t const * ordinal_sums{nullptr};
+
+    // the flagged array handed out by mm_parts_of_speech() for every possible mask
+    int8_t flagged_by_mask[256][synthetic::POS_COUNT];
+
+    struct lists
+    {
+        uint32_t const * offsets{nullptr};
+        int32_t const * entries{nullptr};
+
+        void get(int index, int const * * out, int * count) const
+        {
+            *out = entries + offsets[index];
+            *count = (int) (offsets[index + 1] - offsets[index]);
+        }
+    };
+
+    lists sums;
+    lists synonyms;
+    lists antonyms;
+    lists definitions;
+    lists embedded;
+
+    int32_t const * book_words{nullptr};
+    int32_t const * book_titles{nullptr};
+    int32_t const * chapter_titles{nullptr};
+
+    uint32_t const * location_offsets{nullptr};
+    int32_t const * location_books{nullptr};
+    int32_t const * location_chapters{nullptr};
+    int32_t const * location_paragraphs{nullptr};
+    int32_t const * location_words{nullptr};
+
+    int const empty_list[1] = {0};
+
+
+    bool valid_term(int index)
+    {
+        return index >= 0 && index < term_count;
+    }
+
+
+    bool valid_paragraph(int book, int chapter, int paragraph)
+    {
+        return nullptr != h && book >= 0 && (uint64_t) book < h->book_count
+               && chapter >= 0 && (uint64_t) chapter < h->chapters_per_book
+               && paragraph >= 0 && (uint64_t) paragraph < h->paragraphs_per_chapter;
+    }
+
+
+    // first term not less than word, or first term not starting with word if past_prefix
+    int bound(char const * word, bool past_prefix)
+    {
+        size_t const word_length = std::strlen(word);
+        int low{0};
+        int high{term_count};
+        while (low < high)
+        {
+            int const mid = low + (high - low) / 2;
+            char const * term = term_chars + term_offsets[mid];
+            int const c = past_prefix ? std::strncmp(term, word, word_length) : std::strcmp(term, word);
+            if (past_prefix ? c <= 0 : c < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        return low;
+    }
+
+
+    // runs on loading, possibly before any static object is constructed, so iostreams are not used
+    __attribute__((constructor)) void map_dictionary()
+    {
+        for (int mask = 0; mask < 256; ++mask)
+            for (int p = 0; p < synthetic::POS_COUNT; ++p)
+                flagged_by_mask[mask][p] = (mask >> p) & 1;
+
+        char const * path = std::getenv("MM_SYNTHETIC_DICTIONARY");
+        if (nullptr == path)
+        {
+            std::fprintf(stderr, "matchmaker_synthetic: MM_SYNTHETIC_DICTIONARY is not set, the dictionary is empty\n");
+            return;
+        }
+
+        int const fd = open(path, O_RDONLY);
+        struct stat st;
+        if (fd == -1 || fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(synthetic::header))
+        {
+            std::fprintf(stderr, "matchmaker_synthetic: failed to open %s\n", path);
+            if (fd != -1)
+                close(fd);
+            return;
+        }
+
+        void * mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            std::fprintf(stderr, "matchmaker_synthetic: failed to map %s\n", path);
+            return;
+        }
+
+        h = static_cast<synthetic::header const *>(mapped);
+        mapped_size = st.st_size;
+        if (std::memcmp(h->magic, synthetic::MAGIC, sizeof(synthetic::MAGIC)) != 0)
+        {
+            std::fprintf(stderr, "matchmaker_synthetic: %s is not a synthetic dictionary\n", path);
+            munmap(mapped, mapped_size);
+            h = nullptr;
+            return;
+        }
+
+        term_count = (int) h->term_count;
+        term_offsets = section<uint64_t>(synthetic::TERM_OFFSETS);
+        term_chars = section<char>(synthetic::TERM_CHARS);
+        from_longest_terms = section<int32_t>(synthetic::FROM_LONGEST);
+        as_longest_positions = section<int32_t>(synthetic::AS_LONGEST);
+        lengths = section<int32_t>(synthetic::LENGTHS);
+        length_count = (int) (h->section_sizes[synthetic::LENGTHS] / sizeof(int32_t));
+        length_starts = section<int32_t>(synthetic::LENGTH_STARTS);
+        length_counts = section<int32_t>(synthetic::LENGTH_COUNTS);
+        attributes = section<uint8_t>(synthetic::ATTRIBUTES);
+        pos_masks = section<uint8_t>(synthetic::POS_MASKS);
+        ordinal_sums = section<int32_t>(synthetic::ORDINAL_SUMS);
+        sums = {section<uint32_t>(synthetic::SUM_OFFSETS), section<int32_t>(synthetic::SUM_TERMS)};
+        synonyms = {section<uint32_t>(synthetic::SYNONYM_OFFSETS), section<int32_t>(synthetic::SYNONYMS)};
+        antonyms = {section<uint32_t>(synthetic::ANTONYM_OFFSETS), section<int32_t>(synthetic::ANTONYMS)};
+        definitions = {section<uint32_t>(synthetic::DEFINITION_OFFSETS), section<int32_t>(synthetic::DEFINITIONS)};
+        embedded = {section<uint32_t>(synthetic::EMBEDDED_OFFSETS), section<int32_t>(synthetic::EMBEDDED)};
+        book_words = section<int32_t>(synthetic::BOOK_WORDS);
+        book_titles = section<int32_t>(synthetic::BOOK_TITLES);
+        chapter_titles = section<int32_t>(synthetic::CHAPTER_TITLES);
+        location_offsets = section<uint32_t>(synthetic::LOCATION_OFFSETS);
+        location_books = section<int32_t>(synthetic::LOCATION_BOOKS);
+        location_chapters = section<int32_t>(synthetic::LOCATION_CHAPTERS);
+        location_paragraphs = section<int32_t>(synthetic::LOCATION_PARAGRAPHS);
+        location_words = section<int32_t>(synthetic::LOCATION_WORDS);
+    }
+
+
+    __attribute__((destructor)) void unmap_dictionary()
+    {
+        if (nullptr != h)
+            munmap(const_cast<synthetic::header *>(h), mapped_size);
+        h = nullptr;
+        term_count = 0;
+    }
+}
+
+
+
+extern "C"
+{
+    int mm_count()
+    {
+        return term_count;
+    }
+
+
+    char const * mm_at(int index, int * length)
+    {
+        if (!valid_term(index))
+        {
+            if (nullptr != length)
+                *length = 0;
+            return "";
+        }
+
+        if (nullptr != length)
+            *length = (int) (term_offsets[index + 1] - term_offsets[index] - 1);
+
+        return term_chars + term_offsets[index];
+    }
+
+
+    int mm_lookup(char const * word, bool * found)
+    {
+        int const index = bound(word, false);
+        if (nullptr != found)
+            *found = index < term_count && std::strcmp(term_chars + term_offsets[index], word) == 0;
+
+        return index;
+    }
+
+
+    int mm_as_longest(int index)
+    {
+        return valid_term(index) ? as_longest_positions[index] : -1;
+    }
+
+
+    int mm_from_longest(int length_index)
+    {
+        return valid_term(length_index) ? from_longest_terms[length_index] : -1;
+    }
+
+
+    void mm_lengths(int const * * len_array, int * count)
+    {
+        *len_array = nullptr != lengths ? lengths : empty_list;
+        *count = length_count;
+    }
+
+
+    bool mm_length_location(int length, int * length_index, int * count)
+    {
+        for (int i = 0; i < length_count; ++i)
+        {
+            if (lengths[i] == length)
+            {
+                *length_index = length_starts[i];
+                *count = length_counts[i];
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    int mm_ordinal_summation(int index)
+    {
+        return valid_term(index) ? ordinal_sums[index] : 0;
+    }
+
+
+    void mm_from_ordinal_summation(int summation, int const * * words, int * count)
+    {
+        if (nullptr == h || summation < 0 || (uint64_t) summation > h->max_ordinal_sum)
+        {
+            *words = empty_list;
+            *count = 0;
+            return;
+        }
+
+        sums.get(summation, words, count);
+    }
+
+
+    bool mm_parts_of_speech(int index, char const * const * * pos, int8_t const * * flagged, int * count)
+    {
+        *pos = synthetic::POS_NAMES;
+        *count = synthetic::POS_COUNT;
+        uint8_t const mask = valid_term(index) ? pos_masks[index] : 0;
+        *flagged = flagged_by_mask[mask];
+
+        return mask != 0;
+    }
+
+
+    bool mm_is_name(int index) { return valid_term(index) && (attributes[index] & synthetic::NAME); }
+    bool mm_is_male_name(int index) { return valid_term(index) && (attributes[index] & synthetic::MALE_NAME); }
+    bool mm_is_female_name(int index) { return valid_term(index) && (attributes[index] & synthetic::FEMALE_NAME); }
+    bool mm_is_place(int index) { return valid_term(index) && (attributes[index] & synthetic::PLACE); }
+    bool mm_is_compound(int index) { return valid_term(index) && (attributes[index] & synthetic::COMPOUND); }
+    bool mm_is_acronym(int index) { return valid_term(index) && (attributes[index] & synthetic::ACRONYM); }
+    bool mm_is_phrase(int index) { return valid_term(index) && (attributes[index] & synthetic::PHRASE); }
+
+
+    bool mm_is_used_in_book(int book_index, int index)
+    {
+        if (!valid_term(index))
+            return false;
+
+        for (uint32_t l = location_offsets[index]; l < location_offsets[index + 1]; ++l)
+            if (location_books[l] == book_index)
+                return true;
+
+        return false;
+    }
+
+
+    void mm_synonyms(int index, int const * * syn_array, int * count)
+    {
+        if (valid_term(index))
+            return synonyms.get(index, syn_array, count);
+
+        *syn_array = empty_list;
+        *count = 0;
+    }
+
+
+    void mm_antonyms(int index, int const * * ant_array, int * count)
+    {
+        if (valid_term(index))
+            return antonyms.get(index, ant_array, count);
+
+        *ant_array = empty_list;
+        *count = 0;
+    }
+
+
+    void mm_definition(int index, int const * * def, int * count)
+    {
+        if (valid_term(index))
+            return definitions.get(index, def, count);
+
+        *def = empty_list;
+        *count = 0;
+    }
+
+
+    void mm_embedded(int index, int const * * embedded_words, int * count)
+    {
+        if (valid_term(index))
+            return embedded.get(index, embedded_words, count);
+
+        *embedded_words = empty_list;
+        *count = 0;
+    }
+
+
+    void mm_locations(int index, int const * * book_indexes, int const * * chapter_indexes,
+                      int const * * paragraph_indexes, int const * * word_indexes, int * count)
+    {
+        if (!valid_term(index))
+        {
+            *book_indexes = *chapter_indexes = *paragraph_indexes = *word_indexes = empty_list;
+            *count = 0;
+            return;
+        }
+
+        uint32_t const first = location_offsets[index];
+        *book_indexes = location_books + first;
+        *chapter_indexes = location_chapters + first;
+        *paragraph_indexes = location_paragraphs + first;
+        *word_indexes = location_words + first;
+        *count = (int) (location_offsets[index + 1] - first);
+    }
+
+
+    void mm_complete(char const * prefix, int * start, int * length)
+    {
+        *start = bound(prefix, false);
+        *length = bound(prefix, true) - *start;
+    }
+
+
+    int mm_book_count()
+    {
+        return nullptr == h ? 0 : (int) h->book_count;
+    }
+
+
+    void mm_book_title(int book_index, int const * * title, int * count)
+    {
+        if (!valid_paragraph(book_index, 0, 0))
+        {
+            *title = empty_list;
+            *count = 0;
+            return;
+        }
+
+        *title = book_titles + book_index * (synthetic::TITLE_TERMS + synthetic::AUTHOR_TERMS);
+        *count = synthetic::TITLE_TERMS;
+    }
+
+
+    void mm_book_author(int book_index, int const * * author, int * count)
+    {
+        if (!valid_paragraph(book_index, 0, 0))
+        {
+            *author = empty_list;
+            *count = 0;
+            return;
+        }
+
+        *author = book_titles + book_index * (synthetic::TITLE_TERMS + synthetic::AUTHOR_TERMS)
+                  + synthetic::TITLE_TERMS;
+        *count = synthetic::AUTHOR_TERMS;
+    }
+
+
+    int mm_chapter_count(int book_index)
+    {
+        return valid_paragraph(book_index, 0, 0) ? (int) h->chapters_per_book : 0;
+    }
+
+
+    void mm_chapter_title(int book_index, int chapter_index, int const * * title, int * count)
+    {
+        if (!valid_paragraph(book_index, chapter_index, 0))
+        {
+            *title = empty_list;
+            *count = 0;
+            return;
+        }
+
+        uint64_t const chapter = book_index * h->chapters_per_book + chapter_index;
+        *title = chapter_titles + chapter * (synthetic::TITLE_TERMS + synthetic::SUBTITLE_TERMS);
+        *count = synthetic::TITLE_TERMS;
+    }
+
+
+    void mm_chapter_subtitle(int book_index, int chapter_index, int const * * subtitle, int * count)
+    {
+        if (!valid_paragraph(book_index, chapter_index, 0))
+        {
+            *subtitle = empty_list;
+            *count = 0;
+            return;
+        }
+
+        uint64_t const chapter = book_index * h->chapters_per_book + chapter_index;
+        *subtitle = chapter_titles + chapter * (synthetic::TITLE_TERMS + synthetic::SUBTITLE_TERMS)
+                    + synthetic::TITLE_TERMS;
+        *count = synthetic::SUBTITLE_TERMS;
+    }
+
+
+    int mm_paragraph_count(int book_index, int chapter_index)
+    {
+        return valid_paragraph(book_index, chapter_index, 0) ? (int) h->paragraphs_per_chapter : 0;
+    }
+
+
+    int mm_word_count(int book_index, int chapter_index, int paragraph_index)
+    {
+        return valid_paragraph(book_index, chapter_index, paragraph_index) ? (int) h->words_per_paragraph : 0;
+    }
+
+
+    int mm_word(int book_index, int chapter_index, int paragraph_index, int word_index,
+                int const * * ancestors, int * ancestor_count, int * index_within_first_ancestor,
+                bool * referenced)
+    {
+        // synthetic books have no nested (ancestor) terms or references
+        if (nullptr != ancestors)
+            *ancestors = empty_list;
+        if (nullptr != ancestor_count)
+            *ancestor_count = 0;
+        if (nullptr != index_within_first_ancestor)
+            *index_within_first_ancestor = -1;
+        if (nullptr != referenced)
+            *referenced = false;
+
+        if (!valid_paragraph(book_index, chapter_index, paragraph_index) || word_index < 0
+            || (uint64_t) word_index >= h->words_per_paragraph)
+            return -1;
+
+        uint64_t const paragraph = (book_index * h->chapters_per_book + chapter_index) * h->paragraphs_per_chapter
+                                   + paragraph_index;
+        return book_words[paragraph * h->words_per_paragraph + word_index];
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+
+/*
+    File format shared by the synthetic dictionary generator and the stand-in matchmaker library that
+    maps it. The file starts with a header followed by the sections, each 8 byte aligned. Lists per
+    term are stored as offsets (term_count + 1 entries) into a flat array of term indexes.
+*/
+
+namespace synthetic
+{
+    static char const MAGIC[8] = {'M', 'M', 'S', 'Y', 'N', 'T', 'H', '1'};
+
+    enum section
+    {
+        TERM_OFFSETS,       // uint64_t, term_count + 1 offsets into TERM_CHARS
+        TERM_CHARS,         // char, terms in sorted order, each terminated by '\0'
+        FROM_LONGEST,       // int32_t, term indexes ordered by length (longest first), then by term index
+        AS_LONGEST,         // int32_t, position of each term within FROM_LONGEST
+        LENGTHS,            // int32_t, distinct term lengths, longest first
+        LENGTH_STARTS,      // int32_t, first position within FROM_LONGEST of each length in LENGTHS
+        LENGTH_COUNTS,      // int32_t, number of terms of each length in LENGTHS
+        ATTRIBUTES,         // uint8_t, attribute bits per term, see below
+        POS_MASKS,          // uint8_t, parts of speech bits per term, see POS_NAMES
+        ORDINAL_SUMS,       // int32_t, sum of letter ordinals per term
+        SUM_OFFSETS,        // uint32_t, max_ordinal_sum + 2 offsets into SUM_TERMS
+        SUM_TERMS,          // int32_t, term indexes grouped by ordinal sum
+        SYNONYM_OFFSETS,    // uint32_t
+        SYNONYMS,           // int32_t
+        ANTONYM_OFFSETS,    // uint32_t
+        ANTONYMS,           // int32_t
+        DEFINITION_OFFSETS, // uint32_t
+        DEFINITIONS,        // int32_t
+        EMBEDDED_OFFSETS,   // uint32_t
+        EMBEDDED,           // int32_t
+        BOOK_WORDS,         // int32_t, term per book, chapter, paragraph and word
+        BOOK_TITLES,        // int32_t, TITLE_TERMS + AUTHOR_TERMS terms per book
+        CHAPTER_TITLES,     // int32_t, TITLE_TERMS + SUBTITLE_TERMS terms per chapter
+        LOCATION_OFFSETS,   // uint32_t, term_count + 1 offsets into the LOCATION_ arrays
+        LOCATION_BOOKS,     // int32_t, occurrences grouped by term, in book order
+        LOCATION_CHAPTERS,  // int32_t
+        LOCATION_PARAGRAPHS,// int32_t
+        LOCATION_WORDS,     // int32_t
+        SECTION_COUNT
+    };
+
+    // ATTRIBUTES bits
+    static uint8_t const NAME{1};
+    static uint8_t const MALE_NAME{2};
+    static uint8_t const FEMALE_NAME{4};
+    static uint8_t const PLACE{8};
+    static uint8_t const COMPOUND{16};
+    static uint8_t const ACRONYM{32};
+    static uint8_t const PHRASE{64};
+
+    static int const POS_COUNT{8};
+    static char const * const POS_NAMES[POS_COUNT] = {
+        "noun", "verb", "adjective", "adverb", "pronoun", "preposition", "conjunction", "interjection"
+    };
+
+    static int const TITLE_TERMS{3};
+    static int const AUTHOR_TERMS{2};
+    static int const SUBTITLE_TERMS{2};
+
+    struct header
+    {
+        char magic[8];
+        uint64_t term_count;
+        uint64_t max_ordinal_sum;
+        uint64_t book_count;
+        uint64_t chapters_per_book;
+        uint64_t paragraphs_per_chapter;
+        uint64_t words_per_paragraph;
+        uint64_t section_offsets[SECTION_COUNT]; // in bytes from the start of the file
+        uint64_t section_sizes[SECTION_COUNT];   // in bytes
+    };
+}